@@ -167,6 +167,11 @@ static_assert(MaxCalibrationPoints <= MaxProbePoints, "MaxDeltaCalibrationPoints
 
 // SD card
 constexpr uint32_t SdCardDetectDebounceMillis = 200;	// How long we give the SD card to settle in the socket
+#if SAM4E || SAM4S || SAME70
+constexpr size_t DirectoryCacheSize = 4096;				// Bytes of file names and details that we keep from the last directory listed
+#else
+constexpr size_t DirectoryCacheSize = 1024;
+#endif
 
 // Z probing
 constexpr float DEFAULT_Z_DIVE = 5.0;					// Millimetres
@@ -191,6 +196,18 @@ constexpr size_t GCODE_LENGTH = 161;					// maximum number of non-comment charac
 constexpr size_t GCODE_LENGTH = 101;					// maximum number of non-comment characters in a line of GCode including the null terminator
 #endif
 
+// When printing files of short moves we process extra lines from the file in a pass of the main loop while the movement queue has room for them
+constexpr unsigned int MaxFileBurstLines = 8;			// Maximum number of extra lines from the file being printed per pass of the main loop
+constexpr uint32_t MaxFileBurstMicroseconds = 1000;		// Maximum time spent on those lines per pass of the main loop
+constexpr unsigned int MaxSimulationFileBurstLines = 64;	// Maximum number of extra lines per pass of the main loop when simulating, because the moves take no time
+
+// Number of move segments that GCodes can have ready for the Move module
+#if SAM4E || SAM4S || SAME70
+constexpr size_t MoveQueueLength = 8;
+#else
+constexpr size_t MoveQueueLength = 4;
+#endif
+
 constexpr size_t GCODE_REPLY_LENGTH = 2048;
 constexpr size_t MESSAGE_LENGTH = 256;
 
@@ -202,20 +219,32 @@ constexpr size_t MaxHeaterNameLength = 20;				// Maximum number of characters in
 constexpr uint16_t OUTPUT_BUFFER_SIZE = 256;			// How many bytes does each OutputBuffer hold?
 constexpr size_t OUTPUT_BUFFER_COUNT = 32;				// How many OutputBuffer instances do we have?
 constexpr size_t RESERVED_OUTPUT_BUFFERS = 1;			// Number of reserved output buffers after long responses. Must be enough for an HTTP header
+constexpr uint16_t LARGE_OUTPUT_BUFFER_SIZE = 2048;		// How many bytes does each large OutputBuffer hold?
+constexpr size_t LARGE_OUTPUT_BUFFER_COUNT = 2;			// How many large OutputBuffer instances do we have?
 #elif SAM3XA
 constexpr uint16_t OUTPUT_BUFFER_SIZE = 128;			// How many bytes does each OutputBuffer hold?
 constexpr size_t OUTPUT_BUFFER_COUNT = 32;				// How many OutputBuffer instances do we have?
 constexpr size_t RESERVED_OUTPUT_BUFFERS = 2;			// Number of reserved output buffers after long responses. Must be enough for an HTTP header
+constexpr uint16_t LARGE_OUTPUT_BUFFER_SIZE = 1024;		// How many bytes does each large OutputBuffer hold?
+constexpr size_t LARGE_OUTPUT_BUFFER_COUNT = 1;			// How many large OutputBuffer instances do we have?
 #else
 # error
 #endif
 
+constexpr size_t ResponseChunkSize = 4 * OUTPUT_BUFFER_SIZE;		// How much of a generated response we produce at a time
+constexpr uint32_t SharedStatusResponseMillis = 100;	// How long we give the same status response to HTTP clients that poll at the same time
+
 // Move system
 constexpr float DefaultFeedrate = 3000.0;				// The initial requested feed rate after resetting the printer, in mm/min
 constexpr float DefaultRetractSpeed = 1000.0;			// The default firmware retraction and un-retraction speed, in mm
 constexpr float DefaultRetractLength = 2.0;
 
 constexpr float DefaultArcSegmentLength = 0.2;			// G2 and G3 arc movement commands get split into segments this long
+constexpr float DefaultJunctionDeviation = 0.0;			// Junction deviation in mm for XYZ cornering speeds, zero means use the instantaneous speed change limits
+constexpr float NativeArcMaxEndPointError = 0.01;		// If the end point of an arc is further than this from the circle, we segment it instead of executing it as a single move
+constexpr float DefaultInputShaperFrequency = 40.0;		// Ringing frequency in Hz used by M594 if none is given
+constexpr float DefaultInputShaperDamping = 0.1;		// Damping ratio used by M594 if none is given
+constexpr float MinInputShaperFrequency = 4.0;			// Lower frequencies would need impulse sequences longer than most acceleration phases
 
 constexpr uint32_t DefaultIdleTimeout = 30000;			// Milliseconds
 constexpr float DefaultIdleCurrentFactor = 0.3;			// Proportion of normal motor current that we use for idle hold
@@ -114,6 +114,7 @@ void NetworkTransaction::Set(pbuf *p, ConnectionState *c, TransactionStatus s)
 	status = s;
 	inputPointer = 0;
 	sendBuffer = nullptr;
+	sendBufferPos = 0;
 	fileBeingSent = nullptr;
 	closeRequested = false;
 	nextWrite = nullptr;
@@ -272,16 +273,19 @@ bool NetworkTransaction::Send()
 
 	// Fill up the TCP window with some data chunks from our OutputBuffer instances
 	size_t bytesBeingSent = 0, bytesLeftToSend = TCP_WND;
+	// Status responses and G-code replies may be shared with other transactions, so we keep our own place in the buffer instead of using its read pointer
 	while (sendBuffer != nullptr && bytesLeftToSend > 0)
 	{
-		size_t copyLength = min<size_t>(bytesLeftToSend, sendBuffer->BytesLeft());
-		memcpy(sendingWindow + bytesBeingSent, sendBuffer->Read(copyLength), copyLength);
+		size_t copyLength = min<size_t>(bytesLeftToSend, sendBuffer->DataLength() - sendBufferPos);
+		memcpy(sendingWindow + bytesBeingSent, sendBuffer->Data() + sendBufferPos, copyLength);
+		sendBufferPos += copyLength;
 		bytesBeingSent += copyLength;
 		bytesLeftToSend -= copyLength;
 
-		if (sendBuffer->BytesLeft() == 0)
+		if (sendBufferPos == sendBuffer->DataLength())
 		{
 			sendBuffer = OutputBuffer::Release(sendBuffer);
+			sendBufferPos = 0;
 			if (sendBuffer == nullptr)
 			{
 				sendBuffer = sendStack->Pop();
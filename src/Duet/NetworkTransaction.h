@@ -79,6 +79,7 @@ private:
 	size_t inputPointer;						// amount of data already taken from the first packet buffer
 
 	OutputBuffer *sendBuffer;
+	size_t sendBufferPos;						// how much of sendBuffer we have sent
 	OutputStack *sendStack;
 	FileStore * volatile fileBeingSent;
 
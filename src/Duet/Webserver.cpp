@@ -927,8 +927,11 @@ void Webserver::HttpInterpreter::GetJsonResponse(const char* request, OutputBuff
 				type = 1;
 			}
 
+			// If the client passes the statusSeq value from its last response then we only send what has changed since then
+			const char* const sinceVal = GetKeyValue("since");
+			const uint32_t since = (sinceVal == nullptr) ? 0 : strtoul(sinceVal, nullptr, 10);
 			OutputBuffer::Release(response);
-			response = reprap.GetStatusResponse(type, ResponseSource::HTTP);
+			response = reprap.GetStatusResponse(type, ResponseSource::HTTP, since);
 		}
 		else
 		{
@@ -954,8 +957,10 @@ void Webserver::HttpInterpreter::GetJsonResponse(const char* request, OutputBuff
 	}
 	else if (StringEquals(request, "filelist") && GetKeyValue("dir") != nullptr)
 	{
+		const char* const firstVal = GetKeyValue("first");
+		const unsigned int startAt = (firstVal == nullptr) ? 0 : strtoul(firstVal, nullptr, 10);
 		OutputBuffer::Release(response);
-		response = reprap.GetFilelistResponse(GetKeyValue("dir"));
+		response = reprap.GetFilelistResponse(GetKeyValue("dir"), startAt);
 	}
 	else if (StringEquals(request, "files"))
 	{
@@ -966,8 +971,10 @@ void Webserver::HttpInterpreter::GetJsonResponse(const char* request, OutputBuff
 		}
 		const char* const flagDirsVal = GetKeyValue("flagDirs");
 		const bool flagDirs = flagDirsVal != nullptr && atoi(flagDirsVal) == 1;
+		const char* const firstVal = GetKeyValue("first");
+		const unsigned int startAt = (firstVal == nullptr) ? 0 : strtoul(firstVal, nullptr, 10);
 		OutputBuffer::Release(response);
-		response = reprap.GetFilesResponse(dir, flagDirs);
+		response = reprap.GetFilesResponse(dir, startAt, flagDirs);
 	}
 	else if (StringEquals(request, "fileinfo"))
 	{
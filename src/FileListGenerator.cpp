@@ -0,0 +1,163 @@
+/*
+ * FileListGenerator.cpp
+ *
+ *  Created on: 16 Oct 2026
+ *      Author: agent
+ */
+
+#include "FileListGenerator.h"
+#include "OutputMemory.h"
+#include "Platform.h"
+#include "RepRap.h"
+
+void FileListGenerator::Start(const char *dir, unsigned int first, ListType listType)
+{
+	directory.GetRef().copy(dir);
+	startAt = nextEntry = first;
+	type = listType;
+	state = State::header;
+	firstEntry = true;
+}
+
+// Append the next part of the response. We always write the header and trailer, but we only write an entry if it fits in 'maxBytes'.
+bool FileListGenerator::GetNextChunk(OutputBuffer *buf, size_t maxBytes)
+{
+	MassStorage * const massStorage = reprap.GetPlatform().GetMassStorage();
+	if (state == State::header)
+	{
+		state = State::done;
+
+		// If the requested volume is not mounted, report an error
+		if (!massStorage->CheckDriveMounted(directory.c_str()))
+		{
+			if (type == ListType::filelist)
+			{
+				buf->cat("{\"err\":1}");
+			}
+			else
+			{
+				AppendHeader(buf);
+				AppendTrailer(buf, 0, 1);
+			}
+			return false;
+		}
+
+		// Check if the directory exists
+		if (type == ListType::filelist && !massStorage->DirectoryExists(directory.c_str()))
+		{
+			buf->cat("{\"err\":2}");
+			return false;
+		}
+
+		maxBytes -= min<size_t>(maxBytes, AppendHeader(buf));
+		state = State::entries;
+	}
+
+	if (state == State::entries)
+	{
+		FileInfo fileInfo;
+		bool gotFile = massStorage->FindFirstCached(directory.c_str(), nextEntry, fileInfo);
+		while (gotFile)
+		{
+			if (fileInfo.fileName[0] != '.')			// ignore Mac resource files and Linux hidden files
+			{
+				// Make sure we can end this response properly
+				const size_t nameLength = strlen(fileInfo.fileName);
+				if (maxBytes < ((type == ListType::filelist) ? nameLength + 85 : nameLength * 2 + 20))
+				{
+					// No more space available - stop here
+					return true;
+				}
+
+				// Write delimiter
+				size_t written = 0;
+				if (!firstEntry)
+				{
+					written += buf->cat(',');
+				}
+				firstEntry = false;
+
+				if (type == ListType::filelist)
+				{
+					// Write another file entry
+					written += buf->catf("{\"type\":\"%c\",\"name\":", fileInfo.isDirectory ? 'd' : 'f');
+					written += buf->EncodeString(fileInfo.fileName, FILENAME_LENGTH, false);
+					written += buf->catf(",\"size\":%" PRIu32, fileInfo.size);
+
+					const struct tm * const timeInfo = gmtime(&fileInfo.lastModified);
+					if (timeInfo->tm_year <= /*19*/80)
+					{
+						// Don't send the last modified date if it is invalid
+						written += buf->cat('}');
+					}
+					else
+					{
+						written += buf->catf(",\"date\":\"%04u-%02u-%02uT%02u:%02u:%02u\"}",
+								timeInfo->tm_year + 1900, timeInfo->tm_mon + 1, timeInfo->tm_mday,
+								timeInfo->tm_hour, timeInfo->tm_min, timeInfo->tm_sec);
+					}
+				}
+				else if (type == ListType::filesFlagDirs && fileInfo.isDirectory)
+				{
+					// Write the directory name with a '*' in front of it
+					char filename[FILENAME_LENGTH];
+					filename[0] = '*';
+					SafeStrncpy(filename + 1, fileInfo.fileName, ARRAY_SIZE(filename) - 1);
+					written += buf->EncodeString(filename, FILENAME_LENGTH, false);
+				}
+				else
+				{
+					written += buf->EncodeString(fileInfo.fileName, FILENAME_LENGTH, false);
+				}
+				maxBytes -= min<size_t>(maxBytes, written);
+			}
+			++nextEntry;
+			gotFile = massStorage->FindNextCached(fileInfo);
+		}
+
+		AppendTrailer(buf, 0, 0);
+		state = State::done;
+	}
+	return false;
+}
+
+// End the response early. The client can ask for the rest of it starting at the entry we give in "next".
+void FileListGenerator::Finish(OutputBuffer *buf)
+{
+	if (state == State::entries)
+	{
+		AppendTrailer(buf, nextEntry, 0);
+	}
+	state = State::done;
+}
+
+// Produce the whole response in one go, or as much of it as the free output buffers will hold
+void FileListGenerator::GetResponse(OutputBuffer *buf)
+{
+	if (GetNextChunk(buf, OutputBuffer::GetBytesLeft(buf)))
+	{
+		Finish(buf);
+	}
+}
+
+size_t FileListGenerator::AppendHeader(OutputBuffer *buf) const
+{
+	size_t written = buf->cat("{\"dir\":");
+	written += buf->EncodeString(directory.c_str(), directory.strlen(), false);
+	written += buf->catf(",\"first\":%u,\"files\":[", startAt);
+	return written;
+}
+
+void FileListGenerator::AppendTrailer(OutputBuffer *buf, unsigned int next, unsigned int err) const
+{
+	if (type == ListType::filelist)
+	{
+		buf->catf("],\"next\":%u}", next);
+	}
+	else
+	{
+		buf->catf("],\"next\":%u,\"err\":%u}", next, err);
+	}
+}
+
+// End
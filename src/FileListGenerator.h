@@ -0,0 +1,46 @@
+/*
+ * FileListGenerator.h
+ *
+ *  Created on: 16 Oct 2026
+ *      Author: agent
+ */
+
+#ifndef SRC_FILELISTGENERATOR_H_
+#define SRC_FILELISTGENERATOR_H_
+
+#include "ResponseGenerator.h"
+
+// Class to produce the JSON response to rr_files, rr_filelist and M20 S2 a few entries at a time.
+// We read the entries through the directory cache, starting from the number of the next entry each time, so we don't keep a directory open between chunks.
+class FileListGenerator : public ResponseGenerator
+{
+public:
+	enum class ListType : uint8_t
+	{
+		files,					// the rr_files and M20 S2 response, just the file names
+		filesFlagDirs,			// the same but with directory names prefixed by '*'
+		filelist				// the rr_filelist response, with the type, size and date of each entry
+	};
+
+	FileListGenerator() : startAt(0), nextEntry(0), type(ListType::files), state(State::done), firstEntry(true) { }
+
+	void Start(const char *dir, unsigned int first, ListType listType);
+	bool GetNextChunk(OutputBuffer *buf, size_t maxBytes) override;
+	void Finish(OutputBuffer *buf);								// End the response here, giving the number of the next entry in "next"
+	void GetResponse(OutputBuffer *buf);						// Produce as much of the response as fits in the free output buffers
+
+private:
+	enum class State : uint8_t { header, entries, done };
+
+	size_t AppendHeader(OutputBuffer *buf) const;
+	void AppendTrailer(OutputBuffer *buf, unsigned int next, unsigned int err) const;
+
+	String<FILENAME_LENGTH> directory;
+	unsigned int startAt;										// the number of the first entry that the client asked for
+	unsigned int nextEntry;										// the number of the next entry to send
+	ListType type;
+	State state;
+	bool firstEntry;
+};
+
+#endif /* SRC_FILELISTGENERATOR_H_ */
@@ -11,6 +11,77 @@
 #include "Platform.h"
 #include "RepRap.h"
 
+static_assert(GCODE_LENGTH <= 255, "parameterIndex entries must be able to hold GCODE_LENGTH");
+
+// Convert the text at 'p' to a float. This replaces strtod for G-code parameters, which only use an optional sign, digits, and an optional
+// decimal point followed by more digits. It avoids the double precision arithmetic that strtod uses, which is slow on all our processors.
+// Unlike strtod it doesn't accept exponents (so X1E5 is X=1 followed by E=5), hex, infinity or NaN.
+static float StrToFloat(const char *p)
+{
+	static const float PowersOfTen[] = { 1.0, 1.0e1, 1.0e2, 1.0e3, 1.0e4, 1.0e5, 1.0e6, 1.0e7, 1.0e8, 1.0e9, 1.0e10 };
+	constexpr uint32_t MaxMantissaBeforeDigit = (0xFFFFFFFF - 9)/10;
+
+	while (*p == ' ' || *p == '\t')
+	{
+		++p;
+	}
+
+	bool negative = false;
+	if (*p == '-')
+	{
+		negative = true;
+		++p;
+	}
+	else if (*p == '+')
+	{
+		++p;
+	}
+
+	// Accumulate as many significant digits as will fit in the mantissa and count the decimal places
+	uint32_t mantissa = 0;
+	int exponent = 0;
+	while (isdigit(*p))
+	{
+		if (mantissa <= MaxMantissaBeforeDigit)
+		{
+			mantissa = (10 * mantissa) + (*p - '0');
+		}
+		else
+		{
+			++exponent;						// too many digits, ignore the less significant ones
+		}
+		++p;
+	}
+	if (*p == '.')
+	{
+		++p;
+		while (isdigit(*p))
+		{
+			if (mantissa <= MaxMantissaBeforeDigit)
+			{
+				mantissa = (10 * mantissa) + (*p - '0');
+				--exponent;
+			}
+			++p;
+		}
+	}
+
+	float result = (float)mantissa;
+	while (exponent < 0)
+	{
+		const int e = min<int>(-exponent, (int)ARRAY_SIZE(PowersOfTen) - 1);
+		result /= PowersOfTen[e];
+		exponent += e;
+	}
+	while (exponent > 0)
+	{
+		const int e = min<int>(exponent, (int)ARRAY_SIZE(PowersOfTen) - 1);
+		result *= PowersOfTen[e];
+		exponent -= e;
+	}
+	return (negative) ? -result : result;
+}
+
 // Create a default GCodeBuffer
 GCodeBuffer::GCodeBuffer(const char* id, MessageType mt, bool usesCodeQueue)
 	: machineState(new GCodeMachineState()), identity(id), checksumRequired(false), writingFileDirectory(nullptr),
@@ -30,7 +101,7 @@ void GCodeBuffer::Init()
 	gcodeLineEnd = 0;
 	commandLength = 0;
 	readPointer = -1;
-	hadLineNumber = hadChecksum = timerRunning = false;
+	hadLineNumber = hadChecksum = timerRunning = isBinaryMove = false;
 	computedChecksum = 0;
 	bufferState = GCodeBufferState::parseNotStarted;
 }
@@ -272,11 +343,23 @@ bool GCodeBuffer::LineFinished()
 	return true;
 }
 
+// Record the position of a parameter letter in the current command if we haven't already seen it
+inline void GCodeBuffer::IndexParameter(char c, unsigned int offset)
+{
+	if (c >= 'A' && c <= 'Z' && parameterIndex[c - 'A'] == 0)
+	{
+		parameterIndex[c - 'A'] = (uint8_t)(offset + 1);
+	}
+}
+
 // Decode this command command and find the start of the next one on the same line.
+// We also build the index of parameter letters in the same pass, so that Seen doesn't need to search the command.
 // On entry, 'commandStart' has already been set to the address the start of where the command should be.
 // On return, the state must be set to 'ready' to indicate that a command is available and we should stop adding characters.
 void GCodeBuffer::DecodeCommand()
 {
+	memset(parameterIndex, 0, sizeof(parameterIndex));
+
 	// Check for a valid command letter at the start
 	commandLetter = toupper(gcodeBuffer[commandStart]);
 	hasCommandNumber = false;
@@ -324,7 +407,6 @@ void GCodeBuffer::DecodeCommand()
 		for (commandEnd = parameterStart; commandEnd < gcodeLineEnd; ++commandEnd)
 		{
 			const char c = gcodeBuffer[commandEnd];
-			char c2;
 			if (c == '"')
 			{
 				inQuotes = !inQuotes;
@@ -332,11 +414,13 @@ void GCodeBuffer::DecodeCommand()
 			}
 			else if (!inQuotes)
 			{
-				if (primed && ((c2 = toupper(c)) == 'G' || c2 == 'M'))
+				const char c2 = toupper(c);
+				if (primed && (c2 == 'G' || c2 == 'M'))
 				{
 					break;
 				}
 				primed = (c == ' ' || c == '\t');
+				IndexParameter(c2, commandEnd);
 			}
 		}
 	}
@@ -344,6 +428,19 @@ void GCodeBuffer::DecodeCommand()
 	{
 		parameterStart = commandStart;
 		commandEnd = gcodeLineEnd;
+		bool inQuotes = false;
+		for (unsigned int i = parameterStart; i < commandEnd; ++i)
+		{
+			const char c = gcodeBuffer[i];
+			if (c == '"')
+			{
+				inQuotes = !inQuotes;
+			}
+			else if (!inQuotes)
+			{
+				IndexParameter(toupper(c), i);
+			}
+		}
 	}
 	bufferState = GCodeBufferState::ready;
 }
@@ -369,6 +466,31 @@ void GCodeBuffer::Put(const char *str)
 	Put(str, strlen(str));
 }
 
+// Set up a G0 or G1 command decoded from a binary move record, which took 'recordLength' bytes of the file.
+// The parameters are returned by Seen and GetFValue etc. without any text parsing.
+void GCodeBuffer::PutBinaryMove(bool isG1, bool relative, uint8_t paramMask, const float params[NumBinaryMoveParams], size_t recordLength)
+{
+	Init();
+	isBinaryMove = true;
+	binaryRelative = relative;
+	binaryParamMask = paramMask;
+	memcpy(binaryParams, params, sizeof(binaryParams));
+	commandLength = recordLength;
+
+	// Store the command without its parameters for diagnostics
+	gcodeBuffer[0] = 'G';
+	gcodeBuffer[1] = (isG1) ? '1' : '0';
+	gcodeBuffer[2] = 0;
+	gcodeLineEnd = 2;
+	commandStart = 0;
+	parameterStart = commandEnd = 2;
+	commandLetter = 'G';
+	hasCommandNumber = true;
+	commandNumber = (isG1) ? 1 : 0;
+	commandFraction = -1;
+	bufferState = GCodeBufferState::ready;
+}
+
 void GCodeBuffer::SetFinished(bool f)
 {
 	if (f)
@@ -404,6 +526,21 @@ FilePosition GCodeBuffer::GetFilePosition(size_t bytesCached) const
 // Leave the pointer there for a subsequent read.
 bool GCodeBuffer::Seen(char c)
 {
+	if (isBinaryMove)
+	{
+		// For binary moves we set the read pointer to the index of the parameter
+		const char * const p = strchr(BinaryMoveParamLetters, c);
+		readPointer = (c != 0 && p != nullptr && (binaryParamMask & (1u << (p - BinaryMoveParamLetters))) != 0) ? p - BinaryMoveParamLetters : -1;
+		return readPointer >= 0;
+	}
+
+	if (c >= 'A' && c <= 'Z')
+	{
+		// Use the index built by DecodeCommand
+		readPointer = (int)parameterIndex[c - 'A'] - 1;
+		return readPointer >= 0;
+	}
+
 	bool inQuotes = false;
 	for (readPointer = parameterStart; (unsigned int)readPointer < commandEnd; ++readPointer)
 	{
@@ -426,7 +563,7 @@ float GCodeBuffer::GetFValue()
 {
 	if (readPointer >= 0)
 	{
-		const float result = (float) strtod(&gcodeBuffer[readPointer + 1], 0);
+		const float result = (isBinaryMove) ? binaryParams[readPointer] : StrToFloat(&gcodeBuffer[readPointer + 1]);
 		readPointer = -1;
 		return result;
 	}
@@ -441,25 +578,32 @@ const void GCodeBuffer::GetFloatArray(float arr[], size_t& returnedLength, bool
 	if (readPointer >= 0)
 	{
 		size_t length = 0;
-		bool inList = true;
-		while(inList)
+		if (isBinaryMove)
 		{
-			if (length >= returnedLength)		// array limit has been set in here
-			{
-				reprap.GetPlatform().MessageF(ErrorMessage, "GCodes: Attempt to read a GCode float array that is too long: %s\n", gcodeBuffer);
-				readPointer = -1;
-				returnedLength = 0;
-				return;
-			}
-			arr[length] = (float)strtod(&gcodeBuffer[readPointer + 1], 0);
-			length++;
-			do
-			{
-				readPointer++;
-			} while(gcodeBuffer[readPointer] && (gcodeBuffer[readPointer] != ' ') && (gcodeBuffer[readPointer] != LIST_SEPARATOR));
-			if (gcodeBuffer[readPointer] != LIST_SEPARATOR)
+			arr[length++] = binaryParams[readPointer];		// binary moves have a single value for each parameter
+		}
+		else
+		{
+			bool inList = true;
+			while(inList)
 			{
-				inList = false;
+				if (length >= returnedLength)		// array limit has been set in here
+				{
+					reprap.GetPlatform().MessageF(ErrorMessage, "GCodes: Attempt to read a GCode float array that is too long: %s\n", gcodeBuffer);
+					readPointer = -1;
+					returnedLength = 0;
+					return;
+				}
+				arr[length] = StrToFloat(&gcodeBuffer[readPointer + 1]);
+				length++;
+				do
+				{
+					readPointer++;
+				} while(gcodeBuffer[readPointer] && (gcodeBuffer[readPointer] != ' ') && (gcodeBuffer[readPointer] != LIST_SEPARATOR));
+				if (gcodeBuffer[readPointer] != LIST_SEPARATOR)
+				{
+					inList = false;
+				}
 			}
 		}
 
@@ -667,7 +811,7 @@ int32_t GCodeBuffer::GetIValue()
 {
 	if (readPointer >= 0)
 	{
-		const int32_t result = strtol(&gcodeBuffer[readPointer + 1], 0, 0);
+		const int32_t result = (isBinaryMove) ? (int32_t)lrintf(binaryParams[readPointer]) : strtol(&gcodeBuffer[readPointer + 1], 0, 0);
 		readPointer = -1;
 		return result;
 	}
@@ -681,7 +825,7 @@ uint32_t GCodeBuffer::GetUIValue()
 {
 	if (readPointer >= 0)
 	{
-		const uint32_t result = strtoul(&gcodeBuffer[readPointer + 1], 0, 0);
+		const uint32_t result = (isBinaryMove) ? (uint32_t)lrintf(binaryParams[readPointer]) : strtoul(&gcodeBuffer[readPointer + 1], 0, 0);
 		readPointer = -1;
 		return result;
 	}
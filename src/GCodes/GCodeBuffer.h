@@ -12,6 +12,10 @@
 #include "GCodeMachineState.h"
 #include "MessageType.h"
 
+// Compact binary move records (see FileGCodeInput) carry up to these parameters, in this order
+constexpr size_t NumBinaryMoveParams = 5;
+constexpr char BinaryMoveParamLetters[NumBinaryMoveParams + 1] = "XYZEF";
+
 // Class to hold an individual GCode and provide functions to allow it to be parsed
 class GCodeBuffer
 {
@@ -23,6 +27,8 @@ public:
 	bool Put(char c) __attribute__((hot));				// Add a character to the end
 	void Put(const char *str, size_t len);				// Add an entire string, overwriting any existing content
 	void Put(const char *str);							// Add a null-terminated string, overwriting any existing content
+	void PutBinaryMove(bool isG1, bool relative, uint8_t paramMask, const float params[NumBinaryMoveParams], size_t recordLength);
+														// Set up a G0 or G1 command decoded from a binary move record
 	bool Seen(char c) __attribute__((hot));				// Is a character present?
 
 	char GetCommandLetter() const { return commandLetter; }
@@ -62,6 +68,8 @@ public:
 	void SetToolNumberAdjust(int arg) { toolNumberAdjust = arg; }
 	void SetCommsProperties(uint32_t arg) { checksumRequired = (arg & 1); }
 	bool StartingNewCode() const { return gcodeLineEnd == 0; }
+	bool IsAtLineStart() const { return bufferState == GCodeBufferState::parseNotStarted && commandLength == 0; }
+	bool IsBinaryRelativeMove() const { return isBinaryMove && binaryRelative; }	// True if this is a binary move whose coordinates are offsets
 	MessageType GetResponseMessageType() const { return responseMessageType; }
 	GCodeMachineState& MachineState() const { return *machineState; }
 	GCodeMachineState& OriginalMachineState() const;
@@ -103,6 +111,7 @@ private:
 	void StoreAndAddToChecksum(char c);
 	bool LineFinished();								// Deal with receiving end-of-line and return true if we have a command
 	void DecodeCommand();
+	void IndexParameter(char c, unsigned int offset);	// Record where a parameter letter is if it is the first occurrence
 	bool InternalGetQuotedString(const StringRef& str)
 		pre (gcodeBuffer[readPointer] == '"'; str.IsEmpty());
 	bool InternalGetPossiblyQuotedString(const StringRef& str)
@@ -110,6 +119,7 @@ private:
 
 	GCodeMachineState *machineState;					// Machine state for this gcode source
 	char gcodeBuffer[GCODE_LENGTH];						// The G Code
+	uint8_t parameterIndex[26];							// For each letter A-Z, 1 + the index in gcodeBuffer of its first unquoted occurrence in this command, or 0
 	const char* const identity;							// Where we are from (web, file, serial line etc)
 	unsigned int commandStart;							// Index in the buffer of the command letter of this command
 	unsigned int parameterStart;
@@ -132,6 +142,11 @@ private:
 	int commandNumber;
 	int8_t commandFraction;
 
+	bool isBinaryMove;									// True if the command was decoded from a binary move record, so the parameters are in binaryParams
+	bool binaryRelative;								// True if the parameters of the binary move are offsets from the current position
+	uint8_t binaryParamMask;							// Which of BinaryMoveParamLetters the binary move has
+	float binaryParams[NumBinaryMoveParams];			// The parameters of the binary move
+
 	bool queueCodes;									// Can we queue certain G-codes from this source?
 	bool binaryWriting;									// Executing gcode or writing binary file?
 	uint32_t crc32;										// crc32 of the binary file
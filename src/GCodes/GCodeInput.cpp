@@ -16,23 +16,8 @@ bool GCodeInput::FillBuffer(GCodeBuffer *gb)
 	const size_t bytesToPass = min<size_t>(BytesCached(), GCODE_LENGTH);
 	for (size_t i = 0; i < bytesToPass; i++)
 	{
-		const char c = ReadByte();
-
-		if (gb->IsWritingBinary())
-		{
-			// HTML uploads are handled by the GCodes class
-			reprap.GetGCodes().WriteHTMLToFile(*gb, c);
-		}
-		else if (gb->Put(c))
+		if (PassByte(gb, ReadByte()))
 		{
-			// Check if we can finish a file upload
-			if (gb->WritingFileDirectory() != nullptr)
-			{
-				reprap.GetGCodes().WriteGCodeToFile(*gb);
-				gb->SetFinished(true);
-			}
-
-			// Code is complete, stop here
 			return true;
 		}
 	}
@@ -40,6 +25,29 @@ bool GCodeInput::FillBuffer(GCodeBuffer *gb)
 	return false;
 }
 
+// Pass a byte to a GCodeBuffer and return true if it completed a command
+bool GCodeInput::PassByte(GCodeBuffer *gb, char c)
+{
+	if (gb->IsWritingBinary())
+	{
+		// HTML uploads are handled by the GCodes class
+		reprap.GetGCodes().WriteHTMLToFile(*gb, c);
+	}
+	else if (gb->Put(c))
+	{
+		// Check if we can finish a file upload
+		if (gb->WritingFileDirectory() != nullptr)
+		{
+			reprap.GetGCodes().WriteGCodeToFile(*gb);
+			gb->SetFinished(true);
+		}
+
+		// Code is complete, stop here
+		return true;
+	}
+	return false;
+}
+
 // G-code input class for wrapping around Stream-based hardware ports
 
 void StreamGCodeInput::Reset()
@@ -203,11 +211,16 @@ size_t RegularGCodeInput::BufferSpaceLeft() const
 
 // File-based G-code input source
 
+FileGCodeInput::FileGCodeInput()
+	: buffer(reinterpret_cast<char * const>(buf32)), readingPointer(0), writingPointer(0), bytesCached(0), lastFile(nullptr)
+{
+}
+
 // Reset this input. Should be called when the associated file is being closed
 void FileGCodeInput::Reset()
 {
 	lastFile = nullptr;
-	RegularGCodeInput::Reset();
+	readingPointer = writingPointer = bytesCached = 0;
 }
 
 // Reset this input. Should be called when a specific G-code or macro file is closed outside of the reading context
@@ -219,11 +232,20 @@ void FileGCodeInput::Reset(const FileData &file)
 	}
 }
 
+char FileGCodeInput::ReadByte()
+{
+	const char c = buffer[readingPointer++];
+	if (readingPointer == FileInputBufferSize)
+	{
+		readingPointer = 0;
+	}
+	--bytesCached;
+	return c;
+}
+
 // Read another chunk of G-codes from the file and return true if more data is available
 bool FileGCodeInput::ReadFromFile(FileData &file)
 {
-	const size_t bytesCached = BytesCached();
-
 	// Keep track of the last file we read from
 	if (lastFile != nullptr && lastFile != file.f)
 	{
@@ -234,43 +256,133 @@ bool FileGCodeInput::ReadFromFile(FileData &file)
 			lastFile->Seek(lastFile->Position() - bytesCached);
 		}
 
-		RegularGCodeInput::Reset();
+		readingPointer = writingPointer = bytesCached = 0;
 	}
 	lastFile = file.f;
 
-	// Read more from the file
-	if (bytesCached < GCodeInputFileReadThreshold)
+	// Read more from the file if at least half the buffer is free
+	const size_t spaceLeft = FileInputBufferSize - bytesCached;
+	if (spaceLeft >= FileInputBufferSize/2)
 	{
-		// Reset the read+write pointers for better performance if possible
-		if (readingPointer == writingPointer)
+		if (bytesCached == 0)
 		{
-			readingPointer = writingPointer = 0;
+			// Line the buffer up with the file sectors, because we may have just opened the file or sought within it
+			readingPointer = writingPointer = file.GetPosition() % FileInputBufferSize;
 		}
 
-		// Read blocks with sizes multiple of 4 for HSMCI efficiency
-		uint32_t readBuffer32[(GCodeInputBufferSize + 3) / 4];
-		char * const readBuffer = reinterpret_cast<char * const>(readBuffer32);
+		// Read into the free space up to the end of the ring. If the free space ends before that then stop at a sector boundary,
+		// so that the next read starts at one.
+		size_t bytesToRead = FileInputBufferSize - writingPointer;
+		if (bytesToRead > spaceLeft)
+		{
+			bytesToRead = ((writingPointer + spaceLeft) & ~(FileInputSectorSize - 1)) - writingPointer;
+		}
 
-		int bytesRead = file.Read(readBuffer, BufferSpaceLeft() & (~3));
+		const int bytesRead = file.Read(buffer + writingPointer, bytesToRead);
 		if (bytesRead > 0)
 		{
-			int remaining = GCodeInputBufferSize - writingPointer;
-			if (bytesRead <= remaining)
-			{
-				memcpy(buffer + writingPointer, readBuffer, bytesRead);
-			}
-			else
+			writingPointer = (writingPointer + bytesRead) % FileInputBufferSize;
+			bytesCached += bytesRead;
+		}
+	}
+
+	return bytesCached > 0;
+}
+
+// Fill a GCodeBuffer with the next G-code. This is like GCodeInput::FillBuffer except that binary move records are decoded directly.
+bool FileGCodeInput::FillBuffer(GCodeBuffer *gb)
+{
+	const bool canDoBinary = !gb->IsWritingBinary() && gb->WritingFileDirectory() == nullptr;
+	const size_t bytesToPass = min<size_t>(BytesCached(), GCODE_LENGTH);
+	for (size_t i = 0; i < bytesToPass; i++)
+	{
+		if (canDoBinary && gb->IsAtLineStart())
+		{
+			const uint8_t b = PeekByte(0);
+			if (b == BinaryG0Prefix || (b & BinaryMoveHeaderMask) == BinaryMoveHeader)
 			{
-				memcpy(buffer + writingPointer, readBuffer, remaining);
-				memcpy(buffer, readBuffer + remaining, bytesRead - remaining);
+				return GetBinaryMove(gb);
 			}
-			writingPointer = (writingPointer + bytesRead) % GCodeInputBufferSize;
+		}
 
+		if (PassByte(gb, ReadByte()))
+		{
 			return true;
 		}
 	}
 
-	return bytesCached > 0;
+	return false;
+}
+
+// Decode a binary move record into the GCodeBuffer and return true, or return false if we don't have all of it yet
+bool FileGCodeInput::GetBinaryMove(GCodeBuffer *gb)
+{
+	const size_t available = bytesCached;
+	const bool isG1 = (PeekByte(0) != BinaryG0Prefix);
+	const size_t headerLength = (isG1) ? 1 : 2;
+	if (available < headerLength)
+	{
+		return false;
+	}
+
+	const uint8_t header = PeekByte(headerLength - 1);
+	const bool relative = (header & BinaryMoveRelative) != 0;
+	const uint8_t paramMask = header & 0x1F;				// the parameter bits are in the same order as BinaryMoveParamLetters
+	size_t recordLength = headerLength;
+	for (size_t i = 0; i < NumBinaryMoveParams; ++i)
+	{
+		if ((paramMask & (1u << i)) != 0)
+		{
+			recordLength += (relative && i + 1 < NumBinaryMoveParams) ? 2 : 4;
+		}
+	}
+
+	if ((header & BinaryMoveHeaderMask) != BinaryMoveHeader || available < recordLength)
+	{
+		if ((header & BinaryMoveHeaderMask) == BinaryMoveHeader && lastFile != nullptr && lastFile->Position() < lastFile->Length())
+		{
+			return false;						// the rest of the record will be read from the file soon
+		}
+
+		// The record is invalid or truncated at the end of the file, so discard what we have
+		reprap.GetPlatform().MessageF(ErrorMessage, "Bad binary move record at file position %" PRIu32 "\n",
+										(uint32_t)((lastFile != nullptr) ? lastFile->Position() - available : 0));
+		readingPointer = writingPointer;
+		bytesCached = 0;
+		return false;
+	}
+
+	for (size_t i = 0; i < headerLength; ++i)
+	{
+		(void)ReadByte();
+	}
+
+	float params[NumBinaryMoveParams];
+	for (size_t i = 0; i < NumBinaryMoveParams; ++i)
+	{
+		if ((paramMask & (1u << i)) == 0)
+		{
+			params[i] = 0.0;
+		}
+		else if (relative && i + 1 < NumBinaryMoveParams)
+		{
+			const uint8_t lo = (uint8_t)ReadByte();
+			const int16_t offset = (int16_t)(((uint16_t)(uint8_t)ReadByte() << 8) | lo);
+			params[i] = (float)offset * ((BinaryMoveParamLetters[i] == 'E') ? BinaryMoveExtruderOffsetUnit : BinaryMoveAxisOffsetUnit);
+		}
+		else
+		{
+			uint32_t bits = 0;
+			for (unsigned int shift = 0; shift < 32; shift += 8)
+			{
+				bits |= (uint32_t)(uint8_t)ReadByte() << shift;
+			}
+			memcpy(&params[i], &bits, sizeof(float));
+		}
+	}
+
+	gb->PutBinaryMove(isG1, relative, paramMask, params, recordLength);
+	return true;
 }
 
 // End
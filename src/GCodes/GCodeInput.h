@@ -15,7 +15,17 @@
 
 
 const size_t GCodeInputBufferSize = 256;				// How many bytes can we cache per input source?
-const size_t GCodeInputFileReadThreshold = 128;			// How many free bytes must be available before data is read from the SD card?
+
+const size_t FileInputSectorSize = 512;					// Size of an SD card sector
+#ifndef FILE_INPUT_BUFFER_SECTORS
+# if SAM4E || SAME70
+#  define FILE_INPUT_BUFFER_SECTORS	4					// How many sectors of the file being printed can we cache?
+# else
+#  define FILE_INPUT_BUFFER_SECTORS	2
+# endif
+#endif
+const size_t FileInputBufferSize = FILE_INPUT_BUFFER_SECTORS * FileInputSectorSize;
+static_assert(FILE_INPUT_BUFFER_SECTORS >= 2, "The file input buffer must hold at least two sectors");
 
 
 // This base class is intended to provide incoming G-codes for the GCodeBuffer class
@@ -26,6 +36,9 @@ public:
 	bool FillBuffer(GCodeBuffer *gb);					// Fill a GCodeBuffer with the last available G-code
 	virtual size_t BytesCached() const = 0;				// How many bytes have been cached?
 	virtual char ReadByte() = 0;						// Get the next byte from the source
+
+protected:
+	bool PassByte(GCodeBuffer *gb, char c);				// Pass a byte to a GCodeBuffer and return true if it completed a command
 };
 
 
@@ -88,19 +101,50 @@ protected:
 	size_t writingPointer, readingPointer;
 };
 
-// This class is an expansion of the RegularGCodeInput class to buffer G-codes and to rewind file positions when
-// nested G-code files are started. However buffered codes are not explicitly checked for M112.
-class FileGCodeInput : public RegularGCodeInput
+// Files may contain compact binary move records instead of text G0 and G1 commands. A binary record starts at the beginning of a line and
+// is not followed by a line ending, so binary records and text lines may be mixed freely. The record starts with a header byte in the range
+// 0x80 to 0xBF, which is never the first byte of a UTF8 character, so text lines are never mistaken for binary records. The header byte is
+// preceded by the byte 0xC0 (which never occurs in UTF8 text) for a G0 command, otherwise the command is G1.
+// Bits 0 to 4 of the header say whether the X, Y, Z, E and F parameters are present.
+// If bit 5 is clear, the parameters follow in the order X Y Z E F as 32-bit floats.
+// If bit 5 is set, the X, Y, Z and E parameters are offsets from the current position regardless of G90/G91 and M82/M83, as 16-bit signed
+// integers in units of 0.001 for XYZ and 0.0001 for E. F is still a 32-bit float. This makes typical printing moves 7 to 11 bytes long.
+// All values are little-endian.
+constexpr uint8_t BinaryG0Prefix = 0xC0;
+constexpr uint8_t BinaryMoveHeaderMask = 0xC0;			// mask for the bits that identify a header byte
+constexpr uint8_t BinaryMoveHeader = 0x80;				// value of those bits in a header byte
+constexpr uint8_t BinaryMoveRelative = 0x20;
+constexpr float BinaryMoveAxisOffsetUnit = 0.001;
+constexpr float BinaryMoveExtruderOffsetUnit = 0.0001;
+
+// This class buffers G-codes read from files and rewinds file positions when nested G-code files are started.
+// However buffered codes are not explicitly checked for M112.
+// The buffer is a ring of whole SD card sectors. The byte at file position P is always stored at offset P modulo the buffer size, so once
+// the first read after opening or seeking the file has reached a sector boundary, every read is of whole aligned sectors into a contiguous
+// part of the ring. FatFs transfers those directly from the card into the ring without going through its sector buffer or ours.
+// We read when at least half the ring is free, so that one half is filled while the G-codes in the other half are being processed.
+class FileGCodeInput final : public GCodeInput
 {
 public:
-	FileGCodeInput() : RegularGCodeInput(), lastFile(nullptr) { }
+	FileGCodeInput();
 
 	void Reset() override;								// This should be called when the associated file is being closed
 	void Reset(const FileData &file);					// Should be called when a specific G-code or macro file is closed outside the reading context
+	size_t BytesCached() const override { return bytesCached; }
+	char ReadByte() override;
 
 	bool ReadFromFile(FileData &file);					// Read another chunk of G-codes from the file and return true if more data is available
+	bool FillBuffer(GCodeBuffer *gb);					// Fill a GCodeBuffer with the next G-code, decoding binary move records
 
 private:
+	bool GetBinaryMove(GCodeBuffer *gb);				// Decode a binary move record
+	uint8_t PeekByte(size_t offset) const
+		{ return (uint8_t)buffer[(readingPointer + offset) % FileInputBufferSize]; }
+
+	uint32_t buf32[FileInputBufferSize / 4];
+	char * const buffer;
+	size_t readingPointer, writingPointer;
+	size_t bytesCached;									// needed as well as the pointers because the ring may be completely full
 	FileStore *lastFile;
 };
 
@@ -47,7 +47,7 @@ GCodes::GCodes(Platform& p) :
 #if HAS_VOLTAGE_MONITOR
 	powerFailScript(nullptr),
 #endif
-	isFlashing(false), fileBeingHashed(nullptr), lastWarningMillis(0)
+	moveQueueReadIndex(0), moveQueueWriteIndex(0), isFlashing(false), fileBeingHashed(nullptr), lastWarningMillis(0), fileLinesProcessed(0), fileLinesStartMillis(0), longestFileBurst(0)
 {
 	httpInput = new RegularGCodeInput;
 	telnetInput = new RegularGCodeInput;
@@ -198,6 +198,9 @@ void GCodes::Reset()
 	lastEndstopStates = platform.GetAllEndstopStates();
 	firmwareUpdateModuleMap = 0;
 	lastFilamentError = FilamentSensorStatus::ok;
+	numLayerStarts = 0;
+	firstMoveSinceExtrusion = noFilePosition;
+	lastExtrusionZ = -FLT_MAX;
 
 	codeQueue->Clear();
 	cancelWait = isWaiting = displayNoToolWarning = displayDeltaNotHomedWarning = false;
@@ -319,6 +322,8 @@ void GCodes::Spin()
 		RunStateMachine(gb, reply);			// Execute the state machine
 	}
 
+	FillMoveQueue();
+
 	// Check if we need to display a warning
 	const uint32_t now = millis();
 	if (now - lastWarningMillis >= MinimumWarningInterval)
@@ -339,6 +344,54 @@ void GCodes::Spin()
 	platform.ClassReport(longWait);
 }
 
+// Process another line from the file being printed, if there is one waiting and the Move module has taken the last move we gave it.
+// RepRap::Spin calls this repeatedly after spinning this module and the Move module, spinning the Move module again each time we return true.
+// This lets us queue several short moves in one pass of the main loop, within limits on the number of lines and the time taken.
+// We stop as soon as another input channel has a command waiting, so that a burst never delays commands from the other channels.
+bool GCodes::SpinFileBurst(uint32_t burstStartClocks, unsigned int linesDone)
+{
+	GCodeBuffer& gb = *fileGCode;
+	if (   linesDone >= ((simulationMode != 0) ? MaxSimulationFileBurstLines : MaxFileBurstLines)
+		|| Platform::GetInterruptClocks() - burstStartClocks >= (MaxFileBurstMicroseconds * (DDA::stepClockRate/1000))/1000
+		|| segmentsLeft != 0									// the move queue is full
+		|| IsPaused()
+		|| !autoPauseGCode->IsCompletelyIdle()
+		|| gb.GetState() != GCodeState::normal
+		|| gb.IsExecuting()										// the last command is waiting for something
+		|| gb.MachineState().messageAcknowledged
+		|| !gb.MachineState().fileState.IsLive()
+		|| OtherChannelWaiting()
+	   )
+	{
+		return false;
+	}
+
+	char replyBuffer[gcodeReplyLength];
+	StringRef reply(replyBuffer, ARRAY_SIZE(replyBuffer));
+	reply.Clear();
+	StartNextGCode(gb, reply);
+	FillMoveQueue();
+
+	if (linesDone >= longestFileBurst)
+	{
+		longestFileBurst = linesDone + 1;
+	}
+	return true;
+}
+
+// Return true if any input channel other than the file being printed has a command or some input waiting to be processed
+bool GCodes::OtherChannelWaiting() const
+{
+	for (const GCodeBuffer *gbp : gcodeSources)
+	{
+		if (gbp != fileGCode && gbp->IsReady())
+		{
+			return true;
+		}
+	}
+	return httpInput->BytesCached() != 0 || telnetInput->BytesCached() != 0 || serialInput->BytesCached() != 0 || auxInput->BytesCached() != 0;
+}
+
 // Execute a step of the state machine
 void GCodes::RunStateMachine(GCodeBuffer& gb, StringRef& reply)
 {
@@ -1128,7 +1181,7 @@ void GCodes::RunStateMachine(GCodeBuffer& gb, StringRef& reply)
 	// Firmware retraction/un-retraction states
 	case GCodeState::doingFirmwareRetraction:
 		// We just did the retraction part of a firmware retraction, now we need to do the Z hop
-		if (segmentsLeft == 0)
+		if (AllMovesTaken())
 		{
 			const AxesBitmap xAxes = reprap.GetCurrentXAxes();
 			const AxesBitmap yAxes = reprap.GetCurrentYAxes();
@@ -1156,7 +1209,7 @@ void GCodes::RunStateMachine(GCodeBuffer& gb, StringRef& reply)
 
 	case GCodeState::doingFirmwareUnRetraction:
 		// We just undid the Z-hop part of a firmware un-retraction, now we need to do the un-retract
-		if (segmentsLeft == 0)
+		if (AllMovesTaken())
 		{
 			const Tool * const tool = reprap.GetCurrentTool();
 			if (tool != nullptr)
@@ -1306,6 +1359,7 @@ void GCodes::DoFilePrint(GCodeBuffer& gb, StringRef& reply)
 		// Yes - fill up the GCodeBuffer and run the next code
 		if (fileInput->FillBuffer(&gb))
 		{
+			++fileLinesProcessed;
 			gb.SetFinished(ActOnCode(gb, reply));
 		}
 	}
@@ -1483,12 +1537,13 @@ void GCodes::DoPause(GCodeBuffer& gb, PauseReason reason, const char *msg)
 			ToolOffsetInverseTransform(pauseRestorePoint.moveCoords, currentUserPosition);	// transform the returned coordinates to user coordinates
 			ClearMove();
 		}
-		else if (segmentsLeft != 0 && moveBuffer.canPauseBefore)
+		else if (GetWaitingMove() != nullptr && GetWaitingMove()->canPauseBefore)
 		{
-			// We were not able to skip any moves, however we can skip the move that is waiting
-			pauseRestorePoint.virtualExtruderPosition = moveBuffer.virtualExtruderPosition;
-			pauseRestorePoint.filePos = moveBuffer.filePos;
-			pauseRestorePoint.feedRate = moveBuffer.feedRate;
+			// We were not able to skip any moves, however we can skip the moves that are waiting
+			const RawMove * const waitingMove = GetWaitingMove();
+			pauseRestorePoint.virtualExtruderPosition = waitingMove->virtualExtruderPosition;
+			pauseRestorePoint.filePos = waitingMove->filePos;
+			pauseRestorePoint.feedRate = waitingMove->feedRate;
 			ToolOffsetInverseTransform(pauseRestorePoint.moveCoords, currentUserPosition);	// transform the returned coordinates to user coordinates
 			ClearMove();
 		}
@@ -1617,16 +1672,19 @@ bool GCodes::DoEmergencyPause()
 		ToolOffsetInverseTransform(pauseRestorePoint.moveCoords, currentUserPosition);	// transform the returned coordinates to user coordinates
 		ClearMove();
 	}
-	else if (segmentsLeft != 0 && moveBuffer.filePos != noFilePosition)
-	{
-		// We were not able to skip any moves, however we can skip the remaining segments of this current move
-		ToolOffsetInverseTransform(moveBuffer.initialCoords, currentUserPosition);
-		pauseRestorePoint.feedRate = moveBuffer.feedRate;
-		pauseRestorePoint.virtualExtruderPosition = moveBuffer.virtualExtruderPosition;
-		pauseRestorePoint.filePos = moveBuffer.filePos;
-		pauseRestorePoint.proportionDone = (float)(totalSegments - segmentsLeft)/(float)totalSegments;
+	else if (GetWaitingMove() != nullptr && GetWaitingMove()->filePos != noFilePosition)
+	{
+		// We were not able to skip any moves, however we can skip the moves and segments that are waiting
+		const RawMove * const waitingMove = GetWaitingMove();
+		ToolOffsetInverseTransform(waitingMove->initialCoords, currentUserPosition);
+		pauseRestorePoint.feedRate = waitingMove->feedRate;
+		pauseRestorePoint.virtualExtruderPosition = waitingMove->virtualExtruderPosition;
+		pauseRestorePoint.filePos = waitingMove->filePos;
+		pauseRestorePoint.proportionDone = (waitingMove == &moveBuffer)
+											? (float)(totalSegments - segmentsLeft)/(float)totalSegments
+												: waitingMove->proportionDone;
 #if SUPPORT_IOBITS
-		pauseRestorePoint.ioBits = moveBuffer.ioBits;
+		pauseRestorePoint.ioBits = waitingMove->ioBits;
 #endif
 		ClearMove();
 	}
@@ -1888,7 +1946,15 @@ void GCodes::SaveResumeInfo(bool wasPowerFailure)
 void GCodes::Diagnostics(MessageType mtype)
 {
 	platform.Message(mtype, "=== GCodes ===\n");
-	platform.MessageF(mtype, "Segments left: %u\n", segmentsLeft);
+	platform.MessageF(mtype, "Segments left: %u, moves queued: %u\n", segmentsLeft, NumQueuedMoves());
+
+	const uint32_t now = millis();
+	const uint32_t interval = now - fileLinesStartMillis;
+	platform.MessageF(mtype, "File lines per second: %" PRIu32 ", longest burst %u\n",
+						(interval == 0) ? 0 : (uint32_t)(((uint64_t)fileLinesProcessed * 1000u)/interval), longestFileBurst);
+	fileLinesProcessed = 0;
+	fileLinesStartMillis = now;
+	longestFileBurst = 0;
 	platform.MessageF(mtype, "Stack records: %u allocated, %u in use\n", GCodeMachineState::GetNumAllocated(), GCodeMachineState::GetNumInUse());
 	const GCodeBuffer * const movementOwner = resourceOwners[MoveResource];
 	platform.MessageF(mtype, "Movement lock held by %s\n", (movementOwner == nullptr) ? "null" : movementOwner->GetIdentity());
@@ -1912,7 +1978,7 @@ bool GCodes::LockMovementAndWaitForStandstill(const GCodeBuffer& gb)
 	}
 
 	// Last one gone?
-	if (segmentsLeft != 0)
+	if (!AllMovesTaken())
 	{
 		return false;
 	}
@@ -1997,9 +2063,13 @@ bool GCodes::LoadExtrusionAndFeedrateFromGCode(GCodeBuffer& gb, int moveType)
 				// There may be multiple extruders present but only one value has been specified, so use mixing
 				const float moveArg = eMovement[0] * distanceScale;
 				float requestedExtrusionAmount;
-				if (gb.MachineState().drivesRelative)
+				if (gb.MachineState().drivesRelative || gb.IsBinaryRelativeMove())
 				{
 					requestedExtrusionAmount = moveArg;
+					if (!gb.MachineState().drivesRelative)
+					{
+						virtualExtruderPosition += moveArg;		// keep the absolute position in step so that the next text G1 extrudes the right amount
+					}
 				}
 				else
 				{
@@ -2186,7 +2256,7 @@ bool GCodes::DoStraightMove(GCodeBuffer& gb, StringRef& reply, bool isCoordinate
 			{
 				currentUserPosition[axis] = moveArg + rp->moveCoords[axis];
 			}
-			else if (gb.MachineState().axesRelative)
+			else if (gb.MachineState().axesRelative || gb.IsBinaryRelativeMove())
 			{
 				currentUserPosition[axis] += moveArg;
 			}
@@ -2356,6 +2426,31 @@ bool GCodes::DoArcMove(GCodeBuffer& gb, bool clockwise)
 		totalArc += 2 * PI;
 	}
 
+#if SUPPORT_NATIVE_ARCS
+	// If the kinematics and compensation in use allow it, execute the arc as a single move in which the X and Y motors follow the circle.
+	// The end point must lie on the circle, otherwise we segment the arc so that the last segment takes up the discrepancy.
+	moveBuffer.isArcMove = false;
+	if (   totalArc > 0.0
+		&& moveFractionToSkip == 0.0
+		&& moveBuffer.xAxes == MakeBitmap<AxesBitmap>(X_AXIS)
+		&& moveBuffer.yAxes == MakeBitmap<AxesBitmap>(Y_AXIS)
+		&& reprap.GetMove().CanDoNativeArcs()
+	   )
+	{
+		const float endRadius = sqrtf(fsquare(moveBuffer.coords[X_AXIS] - arcCentre[X_AXIS]) + fsquare(moveBuffer.coords[Y_AXIS] - arcCentre[Y_AXIS]));
+		if (fabsf(endRadius - arcRadius) <= NativeArcMaxEndPointError)
+		{
+			moveBuffer.isArcMove = true;
+			moveBuffer.arcRadius = arcRadius;
+			moveBuffer.arcStartAngle = arcCurrentAngle;
+			moveBuffer.arcTotalAngle = (clockwise) ? -totalArc : totalArc;
+			totalSegments = 1;
+			FinaliseMove(gb);
+			return false;
+		}
+	}
+#endif
+
 	// Compute how many segments we need to move, but don't store it yet
 	totalSegments = max<unsigned int>((unsigned int)((arcRadius * totalArc)/arcSegmentLength + 0.8), 1u);
 	arcAngleIncrement = totalArc/totalSegments;
@@ -2378,6 +2473,10 @@ void GCodes::FinaliseMove(const GCodeBuffer& gb)
 	moveBuffer.canPauseBefore = true;
 	moveBuffer.filePos = (&gb == fileGCode) ? gb.GetFilePosition(fileInput->BytesCached()) : noFilePosition;
 	moveBuffer.virtualExtruderPosition = virtualExtruderPosition;
+	if (moveBuffer.filePos != noFilePosition && moveBuffer.moveType == 0)
+	{
+		CheckForLayerStart();
+	}
 
 	if (totalSegments > 1)
 	{
@@ -2402,15 +2501,107 @@ void GCodes::FinaliseMove(const GCodeBuffer& gb)
 	segmentsLeft = totalSegments;												// do this last, ready for RTOS
 }
 
+// See if the move in moveBuffer, which we are about to queue from the file being printed, starts a new layer.
+// A layer starts with the first move after the last extruding move of the previous layer, so that the Z change and travel are included.
+// We call it a new layer when a move extrudes at a greater Z height than the previous extruding move, which is the same test that PrintMonitor applies to the live position.
+void GCodes::CheckForLayerStart()
+{
+	bool extruding = false;
+	for (size_t drive = numTotalAxes; drive < DRIVES; ++drive)
+	{
+		if (moveBuffer.coords[drive] > 0.0)
+		{
+			extruding = true;
+			break;
+		}
+	}
+
+	if (!extruding)
+	{
+		if (firstMoveSinceExtrusion == noFilePosition)
+		{
+			firstMoveSinceExtrusion = moveBuffer.filePos;
+		}
+		return;
+	}
+
+	if (currentUserPosition[Z_AXIS] > lastExtrusionZ + LAYER_HEIGHT_TOLERANCE)
+	{
+		if (numLayerStarts == NumLayerStartsKept)
+		{
+			memmove(layerStartFilePositions, layerStartFilePositions + 1, (NumLayerStartsKept - 1) * sizeof(layerStartFilePositions[0]));
+			--numLayerStarts;
+		}
+		layerStartFilePositions[numLayerStarts++] = (firstMoveSinceExtrusion != noFilePosition) ? firstMoveSinceExtrusion : moveBuffer.filePos;
+	}
+	lastExtrusionZ = currentUserPosition[Z_AXIS];
+	firstMoveSinceExtrusion = noFilePosition;
+}
+
+// Get the file position of the move that started the layer being executed, given the file position of the executing move.
+// This is the most recent layer start that we queued at or before the executing move. If we don't have one then we return the executing position.
+FilePosition GCodes::GetLayerStartFilePosition(FilePosition executingPos) const
+{
+	if (executingPos != noFilePosition)
+	{
+		for (size_t i = numLayerStarts; i != 0; )
+		{
+			--i;
+			if (layerStartFilePositions[i] <= executingPos)
+			{
+				return layerStartFilePositions[i];
+			}
+		}
+	}
+	return executingPos;
+}
+
 // The Move class calls this function to find what to do next.
+// When we use RTOS this will need a memory barrier between copying the move and advancing the read index, and FillMoveQueue will need one too.
 bool GCodes::ReadMove(RawMove& m)
 {
-	if (segmentsLeft == 0)
+	const size_t readIndex = moveQueueReadIndex;
+	if (readIndex == moveQueueWriteIndex)
 	{
 		return false;
 	}
 
+	m = moveQueue[readIndex];
+	moveQueueReadIndex = (readIndex + 1) % MoveQueueSlots;						// do this last so that we don't overwrite the move while it is being copied
+	return true;
+}
+
+// Put as many segments of the move in moveBuffer in the move queue as there is room for
+void GCodes::FillMoveQueue()
+{
+	while (segmentsLeft != 0)
+	{
+		const size_t writeIndex = moveQueueWriteIndex;
+		const size_t nextWriteIndex = (writeIndex + 1) % MoveQueueSlots;
+		if (nextWriteIndex == moveQueueReadIndex)
+		{
+			break;																// the queue is full
+		}
+		if (GetNextSegment(moveQueue[writeIndex]))
+		{
+			moveQueueWriteIndex = nextWriteIndex;								// do this last so that Move doesn't take the segment before it is complete
+		}
+	}
+}
+
+// Return the first move or segment that the Move module hasn't taken yet, or nullptr if there isn't one
+const GCodes::RawMove *GCodes::GetWaitingMove() const
+{
+	return (moveQueueReadIndex != moveQueueWriteIndex) ? &moveQueue[moveQueueReadIndex]
+			: (segmentsLeft != 0) ? &moveBuffer
+				: nullptr;
+}
+
+// Get the next segment of the move in moveBuffer, returning false if we skipped it because we are resuming part way through the move
+bool GCodes::GetNextSegment(RawMove& m)
+{
 	m = moveBuffer;
+	m.proportionDone = (float)(totalSegments - segmentsLeft)/(float)totalSegments;
 
 	if (segmentsLeft == 1)
 	{
@@ -2424,7 +2615,7 @@ bool GCodes::ReadMove(RawMove& m)
 			}
 		}
 		m.proportionLeft = 0.0;
-		ClearMove();
+		ClearMoveBuffer();
 	}
 	else
 	{
@@ -2480,13 +2671,24 @@ bool GCodes::ReadMove(RawMove& m)
 	return true;
 }
 
+// Discard any moves that the Move module hasn't taken yet.
+// When we use RTOS, this must only be called when the Move module isn't reading from the move queue.
 void GCodes::ClearMove()
+{
+	moveQueueWriteIndex = moveQueueReadIndex;
+	ClearMoveBuffer();
+}
+
+void GCodes::ClearMoveBuffer()
 {
 	segmentsLeft = 0;
 	doingArcMove = false;
 	moveBuffer.endStopsToCheck = 0;
 	moveBuffer.moveType = 0;
 	moveBuffer.isFirmwareRetraction = false;
+#if SUPPORT_NATIVE_ARCS
+	moveBuffer.isArcMove = false;
+#endif
 	moveFractionToSkip = 0.0;
 }
 
@@ -2920,6 +3122,7 @@ bool GCodes::QueueFileToPrint(const char* fileName, StringRef& reply)
 	FileStore * const f = platform.OpenFile(platform.GetGCodeDir(), fileName, OpenMode::read);
 	if (f != nullptr)
 	{
+		(void)f->EnableFastSeek();										// so that resuming the print and returning from macros don't need to walk the FAT
 		fileGCode->SetToolNumberAdjust(0);								// clear tool number adjustment
 		fileGCode->MachineState().volumetricExtrusion = false;			// default to non-volumetric extrusion
 
@@ -2948,6 +3151,9 @@ void GCodes::StartPrinting()
 	fileGCode->OriginalMachineState().fileState.MoveFrom(fileToPrint);
 	fileInput->Reset();
 	lastFilamentError = FilamentSensorStatus::ok;
+	numLayerStarts = 0;
+	firstMoveSinceExtrusion = noFilePosition;
+	lastExtrusionZ = -FLT_MAX;
 	reprap.GetPrintMonitor().StartedPrint();
 	platform.MessageF(LogMessage,
 						(simulationMode == 0) ? "Started printing file %s\n" : "Started simulating printing file %s\n",
@@ -3715,7 +3921,7 @@ GCodeResult GCodes::RetractFilament(GCodeBuffer& gb, bool retract)
 			return GCodeResult::notFinished;
 		}
 
-		if (segmentsLeft != 0)
+		if (!AllMovesTaken())
 		{
 			return GCodeResult::notFinished;
 		}
@@ -3749,6 +3955,7 @@ GCodeResult GCodes::RetractFilament(GCodeBuffer& gb, bool retract)
 				}
 				moveBuffer.feedRate = retractSpeed;
 				moveBuffer.canPauseAfter = false;			// don't pause after a retraction because that could cause too much retraction
+				totalSegments = 1;
 				segmentsLeft = 1;
 			}
 			if (retractHop > 0.0)
@@ -3763,6 +3970,7 @@ GCodeResult GCodes::RetractFilament(GCodeBuffer& gb, bool retract)
 			moveBuffer.coords[Z_AXIS] -= retractHop;
 			currentZHop = 0.0;
 			moveBuffer.canPauseAfter = false;			// don't pause in the middle of a command
+			totalSegments = 1;
 			segmentsLeft = 1;
 			gb.SetState(GCodeState::doingFirmwareUnRetraction);
 		}
@@ -3778,6 +3986,7 @@ GCodeResult GCodes::RetractFilament(GCodeBuffer& gb, bool retract)
 				}
 				moveBuffer.feedRate = unRetractSpeed;
 				moveBuffer.canPauseAfter = true;
+				totalSegments = 1;
 				segmentsLeft = 1;
 			}
 		}
@@ -3903,7 +4112,7 @@ bool GCodes::IsCodeQueueIdle() const
 // This is called from Pid.cpp when there is a heater fault, and from elsewhere in this module.
 void GCodes::StopPrint(bool normalCompletion)
 {
-	segmentsLeft = 0;
+	ClearMove();
 	isPaused = pausePending = false;
 
 	FileData& fileBeingPrinted = fileGCode->OriginalMachineState().fileState;
@@ -3916,7 +4125,6 @@ void GCodes::StopPrint(bool normalCompletion)
 		fileBeingPrinted.Close();
 	}
 
-	reprap.GetMove().ResetMoveCounters();
 	codeQueue->Clear();
 
 	UnlockAll(*fileGCode);
@@ -3936,6 +4144,10 @@ void GCodes::StopPrint(bool normalCompletion)
 		const uint32_t simMinutes = lrintf((reprap.GetMove().GetSimulationTime() + simulationTime)/60.0);
 		platform.MessageF(LoggedGenericMessage, "File %s will print in %" PRIu32 "h %" PRIu32 "m plus heating time\n",
 								printingFilename, simMinutes/60u, simMinutes % 60u);
+		String<FORMAT_STRING_LENGTH> breakdown;
+		breakdown.GetRef().copy("Simulated move time: ");
+		reprap.GetMove().GetSimulationStats().AppendReport(breakdown.GetRef());
+		platform.MessageF(LoggedGenericMessage, "%s\n", breakdown.c_str());
 	}
 	else if (reprap.GetPrintMonitor().IsPrinting())
 	{
@@ -3950,7 +4162,8 @@ void GCodes::StopPrint(bool normalCompletion)
 			printingFilename, printMinutes/60u, printMinutes % 60u);
 	}
 
-	reprap.GetPrintMonitor().StoppedPrint();		// must do this after printing the simulation details because it clears the filename
+	reprap.GetPrintMonitor().StoppedPrint(normalCompletion);	// must do this after printing the simulation details because it clears the filename
+	reprap.GetMove().ResetMoveCounters();						// must do this after PrintMonitor has recorded the number of moves in the file index
 	if (normalCompletion && simulationMode == 0)
 	{
 		platform.GetMassStorage()->Delete(platform.GetSysDir(), RESUME_AFTER_POWER_FAIL_G, true);
@@ -4303,7 +4516,7 @@ void GCodes::CheckReportDue(GCodeBuffer& gb, StringRef& reply) const
 			if (lastAuxStatusReportType >= 0)
 			{
 				// Send a standard status response for PanelDue
-				OutputBuffer * const statusBuf = GenerateJsonStatusResponse(0, -1, ResponseSource::AUX);
+				OutputBuffer * const statusBuf = GenerateJsonStatusResponse(0, -1, 0, ResponseSource::AUX);
 				if (statusBuf != nullptr)
 				{
 					platform.AppendAuxReply(statusBuf);
@@ -4319,9 +4532,9 @@ void GCodes::CheckReportDue(GCodeBuffer& gb, StringRef& reply) const
 	}
 }
 
-// Generate a M408 response
+// Generate a M408 response. For types 2 to 4, 'since' is the statusSeq value from an earlier response, or 0 to get all the sections.
 // Return the output buffer containing the response, or nullptr if we failed
-OutputBuffer *GCodes::GenerateJsonStatusResponse(int type, int seq, ResponseSource source) const
+OutputBuffer *GCodes::GenerateJsonStatusResponse(int type, int seq, uint32_t since, ResponseSource source) const
 {
 	OutputBuffer *statusResponse = nullptr;
 	switch (type)
@@ -4334,7 +4547,7 @@ OutputBuffer *GCodes::GenerateJsonStatusResponse(int type, int seq, ResponseSour
 		case 2:
 		case 3:
 		case 4:
-			statusResponse = reprap.GetStatusResponse(type - 1, source);
+			statusResponse = reprap.GetStatusResponse(type - 1, source, since);
 			break;
 
 		case 5:
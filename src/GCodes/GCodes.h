@@ -108,6 +108,7 @@ public:
 		float virtualExtruderPosition;									// the virtual extruder position at the start of this move
 		FilePosition filePos;											// offset in the file being printed at the start of reading this move
 		float proportionLeft;											// what proportion of the entire move remains after this segment
+		float proportionDone;											// what proportion of the entire move was done before this segment, only valid in the move queue
 		AxesBitmap xAxes;												// axes that X is mapped to
 		AxesBitmap yAxes;												// axes that Y is mapped to
 		EndstopChecks endStopsToCheck;									// endstops to check
@@ -122,14 +123,22 @@ public:
 		uint8_t canPauseAfter : 1;										// true if we can pause just after this move and successfully restart
 		uint8_t hasExtrusion : 1;										// true if the move includes extrusion - only valid if the move was set up by SetupMove
 		uint8_t isCoordinated : 1;										// true if this is a coordinates move
+#if SUPPORT_NATIVE_ARCS
+		uint8_t isArcMove : 1;											// true if this is an arc move to be executed without segmentation
+
+		float arcRadius;												// the radius of the arc in the XY plane
+		float arcStartAngle;											// the angle of the start point from the arc centre
+		float arcTotalAngle;											// the angle moved, positive for anticlockwise moves
+#endif
 	};
   
 	GCodes(Platform& p);
 	void Spin();														// Called in a tight loop to make this class work
+	bool SpinFileBurst(uint32_t burstStartClocks, unsigned int linesDone);	// Process another line from the file being printed if it is worth doing straight away
 	void Init();														// Set it up
 	void Exit();														// Shut it down
 	void Reset();														// Reset some parameter to defaults
-	bool ReadMove(RawMove& m);											// Called by the Move class to get a movement set by the last G Code
+	bool ReadMove(RawMove& m);											// Called by the Move class to get the next move from the move queue
 	void ClearMove();
 	bool QueueFileToPrint(const char* fileName, StringRef& reply);		// Open a file of G Codes to run
 	void StartPrinting();												// Start printing the file already selected
@@ -153,6 +162,7 @@ public:
 	float GetRawExtruderTotalByDrive(size_t extruder) const;			// Get the total extrusion since start of print, for one drive
 	float GetTotalRawExtrusion() const { return rawExtruderTotal; }		// Get the total extrusion since start of print, all drives
 	float GetBabyStepOffset() const { return currentBabyStepZOffset; }	// Get the current baby stepping Z offset
+	FilePosition GetLayerStartFilePosition(FilePosition executingPos) const;	// Get the file position of the move that started the layer being executed
 
 	RegularGCodeInput *GetHTTPInput() const { return httpInput; }
 	RegularGCodeInput *GetTelnetInput() const { return telnetInput; }
@@ -237,6 +247,16 @@ private:
 	bool DoArcMove(GCodeBuffer& gb, bool clockwise)						// Execute an arc move returning true if it was badly-formed
 		pre(segmentsLeft == 0; resourceOwners[MoveResource] == &gb);
 	void FinaliseMove(const GCodeBuffer& gb);							// Adjust the move parameters to account for segmentation and/or part of the move having been done already
+	void CheckForLayerStart();											// See if the file move in moveBuffer starts a new layer
+	bool GetNextSegment(RawMove& m);									// Get the next segment of the move in moveBuffer
+	void FillMoveQueue();												// Put as many segments of the move in moveBuffer in the move queue as there is room for
+	void ClearMoveBuffer();												// Finish with the move in moveBuffer
+	bool OtherChannelWaiting() const;									// Return true if another input channel has something for us to process
+	size_t NumQueuedMoves() const
+		{ return (moveQueueWriteIndex + MoveQueueSlots - moveQueueReadIndex) % MoveQueueSlots; }
+	bool AllMovesTaken() const											// Return true if the Move module has taken all the moves we have for it
+		{ return segmentsLeft == 0 && moveQueueReadIndex == moveQueueWriteIndex; }
+	const RawMove *GetWaitingMove() const;								// Get the first move that the Move module hasn't taken yet
 
 	GCodeResult DoDwell(GCodeBuffer& gb);								// Wait for a bit
 	GCodeResult DoDwellTime(GCodeBuffer& gb, uint32_t dwellMillis);		// Really wait for a bit
@@ -269,7 +289,7 @@ private:
 	void SetToolHeaters(Tool *tool, float temperature, bool both);		// Set all a tool's heaters to the temperature, for M104/M109
 	bool ToolHeatersAtSetTemperatures(const Tool *tool, bool waitWhenCooling) const; // Wait for the heaters associated with the specified tool to reach their set temperatures
 	void GenerateTemperatureReport(StringRef& reply) const;				// Store a standard-format temperature report in reply
-	OutputBuffer *GenerateJsonStatusResponse(int type, int seq, ResponseSource source) const;	// Generate a M408 response
+	OutputBuffer *GenerateJsonStatusResponse(int type, int seq, uint32_t since, ResponseSource source) const;	// Generate a M408 response
 	void CheckReportDue(GCodeBuffer& gb, StringRef& reply) const;		// Check whether we need to report temperatures or status
 
 	void SavePosition(RestorePoint& rp, const GCodeBuffer& gb) const;	// Save position to a restore point
@@ -369,6 +389,13 @@ private:
 	unsigned int segmentsLeft;					// The number of segments left to do in the current move, or 0 if no move available
 	unsigned int totalSegments;					// The total number of segments left in the complete move
 
+	// Segments that are ready for the Move module to take. Only GCodes writes moveQueueWriteIndex and only the Move module writes moveQueueReadIndex,
+	// so neither needs to lock the queue. One slot is always free so that we can tell a full queue from an empty one.
+	static constexpr size_t MoveQueueSlots = MoveQueueLength + 1;
+	RawMove moveQueue[MoveQueueSlots];
+	volatile size_t moveQueueReadIndex;
+	volatile size_t moveQueueWriteIndex;
+
 	unsigned int segmentsLeftToStartAt;
 	float moveFractionToStartAt;				// how much of the next move was printed before the power failure
 	float moveFractionToSkip;
@@ -397,6 +424,12 @@ private:
 	FileData fileToPrint;						// The next file to print
 	FilePosition fileOffsetToPrint;				// The offset to print from
 
+	static constexpr size_t NumLayerStartsKept = 4;
+	FilePosition layerStartFilePositions[NumLayerStartsKept];	// The file positions of the moves that started the most recently queued layers, oldest first
+	size_t numLayerStarts;						// How many entries of layerStartFilePositions are in use
+	FilePosition firstMoveSinceExtrusion;		// The file position of the first move we queued after the last extruding move, or noFilePosition
+	float lastExtrusionZ;						// The user Z coordinate of the last extruding move we queued from the file
+
 	FileStore* fileBeingWritten;				// A file to write G Codes (or sometimes HTML) to
 	FilePosition fileSize;						// Size of the file being written
 
@@ -476,6 +509,9 @@ private:
 	// Misc
 	uint32_t longWait;							// Timer for things that happen occasionally (seconds)
 	uint32_t lastWarningMillis;					// When we last sent a warning message for things that can happen very often
+	uint32_t fileLinesProcessed;				// How many lines we have read from files on the file channel since the last diagnostics report
+	uint32_t fileLinesStartMillis;				// When we started counting them
+	unsigned int longestFileBurst;				// The most lines processed by SpinFileBurst in one pass of the main loop since the last diagnostics report
 	AxesBitmap axesToSenseLength;				// The axes on which we are performing axis length sensing
 	int8_t lastAuxStatusReportType;				// The type of the last status report requested by PanelDue
 	bool isWaiting;								// True if waiting to reach temperature
@@ -36,7 +36,7 @@
 bool GCodes::ActOnCode(GCodeBuffer& gb, StringRef& reply)
 {
 	// Can we queue this code?
-	if (gb.CanQueueCodes() && codeQueue->QueueCode(gb, segmentsLeft))
+	if (gb.CanQueueCodes() && codeQueue->QueueCode(gb, segmentsLeft + NumQueuedMoves()))
 	{
 		HandleReply(gb, false, "");
 		return true;
@@ -458,7 +458,8 @@ bool GCodes::HandleMcode(GCodeBuffer& gb, StringRef& reply)
 
 			if (sparam == 2)
 			{
-				fileResponse = reprap.GetFilesResponse(dir.Pointer(), true);		// Send the file list in JSON format
+				const unsigned int startAt = (gb.Seen('R')) ? gb.GetUIValue() : 0;
+				fileResponse = reprap.GetFilesResponse(dir.Pointer(), startAt, true);	// Send the file list in JSON format
 				fileResponse->cat('\n');
 			}
 			else
@@ -479,10 +480,16 @@ bool GCodes::HandleMcode(GCodeBuffer& gb, StringRef& reply)
 
 				bool encapsulateList = ((&gb != serialGCode && &gb != telnetGCode) || platform.Emulating() != marlin);
 				FileInfo fileInfo;
-				if (platform.GetMassStorage()->FindFirst(dir.Pointer(), fileInfo))
+				bool listedFile = false;
+				if (platform.GetMassStorage()->FindFirstCached(dir.Pointer(), 0, fileInfo))
 				{
 					// iterate through all entries and append each file name
 					do {
+						if (fileInfo.fileName[0] == '.')
+						{
+							continue;				// ignore hidden files, including our print file indexes
+						}
+						listedFile = true;
 						if (encapsulateList)
 						{
 							fileResponse->catf("%c%s%c%c", FILE_LIST_BRACKET, fileInfo.fileName, FILE_LIST_BRACKET, FILE_LIST_SEPARATOR);
@@ -491,8 +498,11 @@ bool GCodes::HandleMcode(GCodeBuffer& gb, StringRef& reply)
 						{
 							fileResponse->catf("%s\n", fileInfo.fileName);
 						}
-					} while (platform.GetMassStorage()->FindNext(fileInfo));
+					} while (platform.GetMassStorage()->FindNextCached(fileInfo));
+				}
 
+				if (listedFile)
+				{
 					if (encapsulateList)
 					{
 						// remove the last separator
@@ -696,6 +706,21 @@ bool GCodes::HandleMcode(GCodeBuffer& gb, StringRef& reply)
 				moveFractionToStartAt = constrain<float>(gb.GetFValue(), 0.0, 1.0);
 			}
 		}
+		else if (gb.Seen('L'))
+		{
+			// Start at a layer, using the index recorded when the file was last printed
+			FilePosition layerPos;
+			if (reprap.GetPrintMonitor().GetLayerFilePosition(gb.GetUIValue(), layerPos))
+			{
+				fileOffsetToPrint = layerPos;
+				moveFractionToStartAt = 0.0;
+			}
+			else
+			{
+				reply.copy("Layer not found in the index of the selected file");
+				result = GCodeResult::error;
+			}
+		}
 		break;
 
 	case 27: // Report print status - Deprecated
@@ -776,7 +801,7 @@ bool GCodes::HandleMcode(GCodeBuffer& gb, StringRef& reply)
 		}
 		break;
 
-	case 37:	// Simulation mode on/off, or simulate a whole file
+	case 37:	// Simulation mode on/off, or simulate a whole file, optionally writing the time of each layer to a CSV file
 		{
 			bool seen = false;
 			uint32_t newSimulationMode;
@@ -834,6 +859,18 @@ bool GCodes::HandleMcode(GCodeBuffer& gb, StringRef& reply)
 					if (QueueFileToPrint(simFileName.c_str(), reply))
 					{
 						exitSimulationWhenFileComplete = true;
+						String<FILENAME_LENGTH> layerLogFileName;
+						bool seenLayerLog = false;
+						gb.TryGetPossiblyQuotedString('L', layerLogFileName.GetRef(), seenLayerLog);
+						if (seenLayerLog)
+						{
+							FileStore * const f = platform.OpenFile(platform.GetGCodeDir(), layerLogFileName.c_str(), OpenMode::write);
+							if (f == nullptr)
+							{
+								platform.MessageF(WarningMessage, "Failed to create layer times file %s\n", layerLogFileName.c_str());
+							}
+							reprap.GetMove().GetSimulationStats().SetLayerLog(f);
+						}
 						reprap.GetPrintMonitor().StartingPrint(simFileName.c_str());
 						StartPrinting();
 						reply.printf("Simulating print of file %s", simFileName.c_str());
@@ -850,6 +887,11 @@ bool GCodes::HandleMcode(GCodeBuffer& gb, StringRef& reply)
 			{
 				reply.printf("Simulation mode: %s, move time: %.1f sec, other time: %.1f sec",
 						(simulationMode != 0) ? "on" : "off", (double)reprap.GetMove().GetSimulationTime(), (double)simulationTime);
+				if (reprap.GetMove().GetSimulationTime() > 0.0)
+				{
+					reply.cat(", moves ");
+					reprap.GetMove().GetSimulationStats().AppendReport(reply);
+				}
 			}
 		}
 		break;
@@ -1431,6 +1473,17 @@ bool GCodes::HandleMcode(GCodeBuffer& gb, StringRef& reply)
 			{
 				reprap.Diagnostics(gb.GetResponseMessageType());
 			}
+			else if (val == (int)DiagnosticTestType::TestSdThroughput)
+			{
+				// M122 P104 S<megabytes> C<card>
+				if (!LockFileSystem(gb))
+				{
+					return false;
+				}
+				const size_t card = (gb.Seen('C')) ? gb.GetUIValue() : 0;
+				const uint32_t megabytes = (gb.Seen('S')) ? constrain<uint32_t>(gb.GetUIValue(), 1, 1000) : 1;
+				result = platform.GetMassStorage()->TestThroughput(card, megabytes * 1024 * 1024, reply);
+			}
 			else
 			{
 				result = GetGCodeResultFromError(platform.DiagnosticTest(gb, reply, val));
@@ -1756,9 +1809,20 @@ bool GCodes::HandleMcode(GCodeBuffer& gb, StringRef& reply)
 				platform.SetMaxTravelAcceleration(gb.GetFValue());
 				seen = true;
 			}
+#if SUPPORT_S_CURVE
+			if (gb.Seen('C'))
+			{
+				// C0 = constant acceleration (trapezoidal speed profile), C1 = jerk-limited S-curve
+				platform.SetSCurveAcceleration(gb.GetIValue() != 0);
+				seen = true;
+			}
+#endif
 			if (!seen)
 			{
 				reply.printf("Maximum printing acceleration %.1f, maximum travel acceleration %.1f", (double)platform.GetMaxPrintingAcceleration(), (double)platform.GetMaxTravelAcceleration());
+#if SUPPORT_S_CURVE
+				reply.catf(", %s acceleration profile", (platform.UseSCurveAcceleration()) ? "S-curve" : "trapezoidal");
+#endif
 			}
 		}
 		break;
@@ -1863,6 +1927,14 @@ bool GCodes::HandleMcode(GCodeBuffer& gb, StringRef& reply)
 				{
 					moveBuffer.feedRate *= speedFactorRatio;
 				}
+				// Likewise the segments in the move queue that the Move module hasn't taken yet. It takes them in the same task as us, so we can change them here.
+				for (size_t i = moveQueueReadIndex; i != moveQueueWriteIndex; i = (i + 1) % MoveQueueSlots)
+				{
+					if (!moveQueue[i].isFirmwareRetraction)
+					{
+						moveQueue[i].feedRate *= speedFactorRatio;
+					}
+				}
 				speedFactor = newSpeedFactor;
 			}
 			else
@@ -1890,9 +1962,18 @@ bool GCodes::HandleMcode(GCodeBuffer& gb, StringRef& reply)
 					const float extrusionFactor = gb.GetFValue() / 100.0;
 					if (extrusionFactor >= 0.0)
 					{
+						const float extrusionFactorRatio = extrusionFactor/extrusionFactors[extruder];
 						if (segmentsLeft != 0 && !moveBuffer.isFirmwareRetraction)
 						{
-							moveBuffer.coords[extruder + numTotalAxes] *= extrusionFactor/extrusionFactors[extruder];	// last move not gone, so update it
+							moveBuffer.coords[extruder + numTotalAxes] *= extrusionFactorRatio;		// last move not gone, so update it
+						}
+						// Likewise the segments in the move queue that the Move module hasn't taken yet. It takes them in the same task as us, so we can change them here.
+						for (size_t i = moveQueueReadIndex; i != moveQueueWriteIndex; i = (i + 1) % MoveQueueSlots)
+						{
+							if (!moveQueue[i].isFirmwareRetraction)
+							{
+								moveQueue[i].coords[extruder + numTotalAxes] *= extrusionFactorRatio;
+							}
 						}
 						extrusionFactors[extruder] = extrusionFactor;
 					}
@@ -2349,12 +2430,13 @@ bool GCodes::HandleMcode(GCodeBuffer& gb, StringRef& reply)
 		{
 			const int type = gb.Seen('S') ? gb.GetIValue() : 0;
 			const int seq = gb.Seen('R') ? gb.GetIValue() : -1;
+			const uint32_t since = gb.Seen('D') ? gb.GetUIValue() : 0;		// only report the sections that have changed since this status sequence number
 			if (&gb == auxGCode)
 			{
 				lastAuxStatusReportType = type;
 			}
 
-			OutputBuffer * const statusResponse = GenerateJsonStatusResponse(type, seq, (&gb == auxGCode) ? ResponseSource::AUX : ResponseSource::Generic);
+			OutputBuffer * const statusResponse = GenerateJsonStatusResponse(type, seq, since, (&gb == auxGCode) ? ResponseSource::AUX : ResponseSource::Generic);
 
 			if (statusResponse != nullptr)
 			{
@@ -2866,7 +2948,14 @@ bool GCodes::HandleMcode(GCodeBuffer& gb, StringRef& reply)
 					platform.SetInstantDv(numTotalAxes + e, eVals[e] * distanceScale * SecondsToMinutes);
 				}
 			}
-			else if (!seen)
+
+			if (gb.Seen('J'))
+			{
+				platform.SetJunctionDeviation(gb.GetFValue() * distanceScale);
+				seen = true;
+			}
+
+			if (!seen)
 			{
 				reply.copy("Maximum jerk rates: ");
 				for (size_t axis = 0; axis < numTotalAxes; ++axis)
@@ -2880,6 +2969,10 @@ bool GCodes::HandleMcode(GCodeBuffer& gb, StringRef& reply)
 					reply.catf("%c%.1f", sep, (double)(platform.ConfiguredInstantDv(extruder + numTotalAxes) / (distanceScale * SecondsToMinutes)));
 					sep = ':';
 				}
+				if (platform.GetJunctionDeviation() > 0.0)
+				{
+					reply.catf(", junction deviation %.3f", (double)(platform.GetJunctionDeviation() / distanceScale));
+				}
 			}
 		}
 		break;
@@ -3444,6 +3537,24 @@ bool GCodes::HandleMcode(GCodeBuffer& gb, StringRef& reply)
 		// TODO: We may need this code later to restrict specific filaments to certain tools or to reset filament counters.
 		break;
 
+#if SUPPORT_INPUT_SHAPING
+	case 594: // Configure input shaping
+		if (!LockMovementAndWaitForStandstill(gb))
+		{
+			return false;
+		}
+		result = reprap.GetMove().GetShaper().Configure(gb, reply);
+		break;
+#endif
+
+	case 595: // Configure movement queue
+		if (!LockMovementAndWaitForStandstill(gb))
+		{
+			return false;
+		}
+		result = reprap.GetMove().ConfigureMovementQueue(gb, reply);
+		break;
+
 	case 665: // Set delta configuration
 		if (!LockMovementAndWaitForStandstill(gb))
 		{
@@ -619,6 +619,7 @@ GCodeResult GCodes::ProbeTool(GCodeBuffer& gb, StringRef& reply)
 			moveBuffer.feedRate = gb.MachineState().feedrate;
 
 			// Kick off new movement
+			totalSegments = 1;
 			segmentsLeft = 1;
 			gb.SetState(GCodeState::probingToolOffset);
 		}
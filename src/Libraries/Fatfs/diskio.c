@@ -83,6 +83,43 @@ extern "C" {
 #define SECTOR_SIZE_2048 4
 #define SECTOR_SIZE_4096 8
 
+#if SUPPORT_RAM_DISK
+
+#include "conf_fatfs.h"
+
+/** Memory images attached to drives in place of their memory devices */
+static struct {
+	BYTE *image;
+	DWORD num_sectors;
+} ram_disks[_VOLUMES];
+
+/**
+ * \brief Attach a memory image to a drive in place of its memory device,
+ * or detach it if the image is NULL.
+ *
+ * \param drv Physical drive number (0..).
+ * \param image The image, which must hold a FAT file system with 512-byte sectors.
+ * \param num_sectors The size of the image in sectors.
+ */
+void disk_attach_ram(BYTE drv, BYTE *image, DWORD num_sectors)
+{
+	if (drv < _VOLUMES) {
+		ram_disks[drv].image = image;
+		ram_disks[drv].num_sectors = (image != NULL) ? num_sectors : 0;
+	}
+}
+
+/**
+ * \brief Return the size in sectors of the memory image attached to a drive,
+ * or 0 if the drive uses its memory device.
+ */
+DWORD disk_ram_sectors(BYTE drv)
+{
+	return (drv < _VOLUMES) ? ram_disks[drv].num_sectors : 0;
+}
+
+#endif
+
 /**
  * \brief Initialize a disk.
  *
@@ -93,6 +130,12 @@ extern "C" {
  */
 DSTATUS disk_initialize(BYTE drv)
 {
+#if SUPPORT_RAM_DISK
+	if (disk_ram_sectors(drv) != 0) {
+		return 0;
+	}
+#endif
+
 #if (SAM3S || SAM3U || SAM3N || SAM3XA_SERIES || SAM4S)
 	/* Default RTC configuration, 24-hour mode */
 	/**@TODO FIX THIS - need an RTC*/
@@ -143,6 +186,12 @@ DSTATUS disk_initialize(BYTE drv)
  */
 DSTATUS disk_status(BYTE drv)
 {
+#if SUPPORT_RAM_DISK
+	if (disk_ram_sectors(drv) != 0) {
+		return 0;
+	}
+#endif
+
 	switch (mem_test_unit_ready(drv)) {
 	case CTRL_GOOD:
 		return 0;
@@ -166,6 +215,16 @@ DSTATUS disk_status(BYTE drv)
 DRESULT disk_read(BYTE drv, BYTE *buff, DWORD sector, BYTE count)
 {
 //	debugPrintf("R %u %u\n", sector, count);
+#if SUPPORT_RAM_DISK
+	if (disk_ram_sectors(drv) != 0) {
+		if (sector + count > ram_disks[drv].num_sectors) {
+			return RES_PARERR;
+		}
+		memcpy(buff, ram_disks[drv].image + sector * SECTOR_SIZE_DEFAULT, count * SECTOR_SIZE_DEFAULT);
+		return RES_OK;
+	}
+#endif
+
 #if ACCESS_MEM_TO_RAM
 	uint8_t uc_sector_size = mem_sector_size(drv);
 	uint32_t ul_last_sector_num;
@@ -211,6 +270,16 @@ DRESULT disk_read(BYTE drv, BYTE *buff, DWORD sector, BYTE count)
 DRESULT disk_write(BYTE drv, BYTE const *buff, DWORD sector, BYTE count)
 {
 //	debugPrintf("W %u %u\n", sector, count);
+#if SUPPORT_RAM_DISK
+	if (disk_ram_sectors(drv) != 0) {
+		if (sector + count > ram_disks[drv].num_sectors) {
+			return RES_PARERR;
+		}
+		memcpy(ram_disks[drv].image + sector * SECTOR_SIZE_DEFAULT, buff, count * SECTOR_SIZE_DEFAULT);
+		return RES_OK;
+	}
+#endif
+
 #if ACCESS_MEM_TO_RAM
 	uint8_t uc_sector_size = mem_sector_size(drv);
 	uint32_t ul_last_sector_num;
@@ -269,6 +338,30 @@ DRESULT disk_ioctl(BYTE drv, BYTE ctrl, void *buff)
 {
 	DRESULT res = RES_PARERR;
 
+#if SUPPORT_RAM_DISK
+	if (disk_ram_sectors(drv) != 0) {
+		switch (ctrl) {
+		case GET_BLOCK_SIZE:
+			*(DWORD *)buff = 1;
+			return RES_OK;
+
+		case GET_SECTOR_COUNT:
+			*(DWORD *)buff = ram_disks[drv].num_sectors;
+			return RES_OK;
+
+		case GET_SECTOR_SIZE:
+			*(WORD *)buff = SECTOR_SIZE_DEFAULT;
+			return RES_OK;
+
+		case CTRL_SYNC:
+			return RES_OK;
+
+		default:
+			return RES_PARERR;
+		}
+	}
+#endif
+
 	switch (ctrl) {
 	case GET_BLOCK_SIZE:
 		*(DWORD *)buff = 1;
@@ -35,6 +35,24 @@ DRESULT disk_write (BYTE, const BYTE*, DWORD, BYTE);
 #endif
 DRESULT disk_ioctl (BYTE, BYTE, void*);
 
+/* RAM disk support. When a memory image is attached to a drive, the disk functions use the image instead of the memory device.
+/  The image must hold a FAT file system with 512-byte sectors. On a host computer it can be a memory-mapped disk image file.
+/  This is the only place that SUPPORT_RAM_DISK is defined, so that the C and C++ files agree. To enable it, define it on the compiler command line. */
+#ifndef SUPPORT_RAM_DISK
+#define SUPPORT_RAM_DISK	0
+#endif
+
+#if SUPPORT_RAM_DISK
+#ifdef __cplusplus
+extern "C" {
+#endif
+void disk_attach_ram (BYTE, BYTE*, DWORD);
+DWORD disk_ram_sectors (BYTE);
+#ifdef __cplusplus
+}
+#endif
+#endif
+
 
 
 /* Disk Status Bits (DSTATUS) */
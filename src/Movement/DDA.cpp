@@ -152,6 +152,84 @@ inline void DDA::InsertDM(DriveMovement *dm)
 	*dmp = dm;
 }
 
+#if DM_SCHEDULER_HEAP
+
+DriveMovement *DDA::dmHeap[DRIVES];
+size_t DDA::dmHeapSize = 0;
+
+// Add a DM to the heap of drives of the executing move that have steps due
+/*static*/ inline void DDA::PushDM(DriveMovement *dm)
+{
+	size_t index = dmHeapSize++;
+	while (index != 0)
+	{
+		const size_t parent = (index - 1)/2;
+		if (dmHeap[parent]->nextStepTime <= dm->nextStepTime)
+		{
+			break;
+		}
+		dmHeap[index] = dmHeap[parent];
+		index = parent;
+	}
+	dmHeap[index] = dm;
+}
+
+// Remove the DM at the specified position in the heap, by moving the last DM into its place and restoring the heap order
+/*static*/ inline void DDA::RemoveDMAt(size_t index)
+{
+	--dmHeapSize;
+	if (index == dmHeapSize)
+	{
+		return;
+	}
+
+	DriveMovement * const dm = dmHeap[dmHeapSize];
+
+	// If we are not removing the top entry, the moved DM may need to go up the heap
+	while (index != 0 && dmHeap[(index - 1)/2]->nextStepTime > dm->nextStepTime)
+	{
+		dmHeap[index] = dmHeap[(index - 1)/2];
+		index = (index - 1)/2;
+	}
+
+	// Otherwise it may need to go down
+	for (;;)
+	{
+		size_t child = (2 * index) + 1;
+		if (child >= dmHeapSize)
+		{
+			break;
+		}
+		if (child + 1 < dmHeapSize && dmHeap[child + 1]->nextStepTime < dmHeap[child]->nextStepTime)
+		{
+			++child;
+		}
+		if (dm->nextStepTime <= dmHeap[child]->nextStepTime)
+		{
+			break;
+		}
+		dmHeap[index] = dmHeap[child];
+		index = child;
+	}
+	dmHeap[index] = dm;
+}
+
+// Remove this drive from the heap of drives with steps due
+// Called from the step ISR only.
+void DDA::RemoveDM(size_t drive)
+{
+	for (size_t i = 0; i < dmHeapSize; ++i)
+	{
+		if (dmHeap[i]->drive == drive)
+		{
+			RemoveDMAt(i);
+			break;
+		}
+	}
+}
+
+#else
+
 // Remove this drive from the list of drives with steps due
 // Called from the step ISR only.
 void DDA::RemoveDM(size_t drive)
@@ -169,6 +247,8 @@ void DDA::RemoveDM(size_t drive)
 	}
 }
 
+#endif
+
 void DDA::DebugPrintVector(const char *name, const float *vec, size_t len) const
 {
 	debugPrintf("%s=", name);
@@ -197,6 +277,12 @@ void DDA::DebugPrint() const
 
 	debugPrintf(" d=%f", (double)totalDistance);
 	DebugPrintVector(" vec", directionVector, 5);
+#if SUPPORT_NATIVE_ARCS
+	if (isArcMove)
+	{
+		debugPrintf(" arc r=%f a0=%f da=%f", (double)arcRadius, (double)arcStartAngle, (double)arcTotalAngle);
+	}
+#endif
 	debugPrintf("\n"
 				"a=%f reqv=%f startv=%f topv=%f endv=%f daccel=%f ddecel=%f\n"
 				"cks=%" PRIu32 " sstcda=%" PRIu32 " tstcdapdsc=%" PRIu32 " exac=%" PRIi32 "\n",
@@ -271,6 +357,36 @@ bool DDA::Init(GCodes::RawMove &nextMove, bool doMotorMapping)
 	float accelerations[DRIVES];
 	const float * const normalAccelerations = reprap.GetPlatform().Accelerations();
 	const size_t numAxes = reprap.GetGCodes().GetTotalAxes();
+
+#if SUPPORT_NATIVE_ARCS
+	// 1a. If it's an arc move, set up the X and Y drives to follow the circle.
+	// Their end points depend on the path taken, because each of them may reverse direction during the arc.
+	isArcMove = nextMove.isArcMove && doMotorMapping;
+	if (isArcMove)
+	{
+		arcRadius = nextMove.arcRadius;
+		arcStartAngle = nextMove.arcStartAngle;
+		arcTotalAngle = nextMove.arcTotalAngle;
+		xyMoving = true;
+		for (size_t drive = X_AXIS; drive <= Y_AXIS; ++drive)
+		{
+			DriveMovement * const pdm = DriveMovement::Allocate(drive, DMState::moving);
+			endPoint[drive] = positionNow[drive] + pdm->InitArcAxis(*this, reprap.GetPlatform().DriveStepsPerUnit(drive), (drive == X_AXIS) ? 0.0 : PI/2);
+			if (pdm->totalSteps == 0)
+			{
+				DriveMovement::Release(pdm);
+			}
+			else
+			{
+				pddm[drive] = pdm;
+				realMove = true;
+			}
+		}
+	}
+#else
+	isArcMove = false;
+#endif
+
 	for (size_t drive = 0; drive < DRIVES; drive++)
 	{
 		accelerations[drive] = normalAccelerations[drive];
@@ -300,7 +416,11 @@ bool DDA::Init(GCodes::RawMove &nextMove, bool doMotorMapping)
 			}
 		}
 
-		if (delta != 0)
+		if (delta != 0
+#if SUPPORT_NATIVE_ARCS
+			&& pddm[drive] == nullptr					// the DMs for the X and Y axes of an arc move have already been set up
+#endif
+		   )
 		{
 			realMove = true;
 			DriveMovement*& pdm = pddm[drive];
@@ -387,6 +507,17 @@ bool DDA::Init(GCodes::RawMove &nextMove, bool doMotorMapping)
 	// 4. Normalise the direction vector and compute the amount of motion.
 	if (xyMoving)
 	{
+#if SUPPORT_NATIVE_ARCS
+		if (isArcMove)
+		{
+			// Make the XY part of the direction vector tangential to the start of the arc and equal in length to the arc.
+			// After normalisation, the direction vector is the direction at the start of the move and the total distance is the length of the helix.
+			const float arcLength = arcRadius * arcTotalAngle;		// negative if clockwise
+			directionVector[X_AXIS] = -sinf(arcStartAngle) * arcLength;
+			directionVector[Y_AXIS] = cosf(arcStartAngle) * arcLength;
+		}
+#endif
+
 		// There is some XY movement, so normalise the direction vector so that the total XYZ movement has unit length and 'totalDistance' is the XYZ distance moved.
 		// This means that the user gets the feed rate that he asked for. It also makes the delta calculations simpler.
 		// First do the bed tilt compensation for deltas.
@@ -394,6 +525,17 @@ bool DDA::Init(GCodes::RawMove &nextMove, bool doMotorMapping)
 		directionVector[Z_AXIS] += (directionVector[X_AXIS] * k.GetTiltCorrection(X_AXIS)) + (directionVector[Y_AXIS] * k.GetTiltCorrection(Y_AXIS));
 
 		totalDistance = NormaliseXYZ();
+
+#if SUPPORT_NATIVE_ARCS
+		if (isArcMove)
+		{
+			// The lookahead needs to know the direction at the end of the arc too
+			const float xyFraction = arcRadius * arcTotalAngle/totalDistance;	// negative if clockwise
+			const float endAngle = arcStartAngle + arcTotalAngle;
+			arcEndDirection[X_AXIS] = -sinf(endAngle) * xyFraction;
+			arcEndDirection[Y_AXIS] = cosf(endAngle) * xyFraction;
+		}
+#endif
 	}
 	else
 	{
@@ -410,6 +552,13 @@ bool DDA::Init(GCodes::RawMove &nextMove, bool doMotorMapping)
 	float normalisedDirectionVector[DRIVES];			// Used to hold a unit-length vector in the direction of motion
 	memcpy(normalisedDirectionVector, directionVector, sizeof(normalisedDirectionVector));
 	Absolute(normalisedDirectionVector, DRIVES);
+#if SUPPORT_NATIVE_ARCS
+	if (isArcMove)
+	{
+		// The direction of an arc move changes as it proceeds, so allow for either of the X and Y axes moving at the full XY speed
+		normalisedDirectionVector[X_AXIS] = normalisedDirectionVector[Y_AXIS] = arcRadius * fabsf(arcTotalAngle)/totalDistance;
+	}
+#endif
 	acceleration = VectorBoxIntersection(normalisedDirectionVector, accelerations, DRIVES);
 	if (xyMoving)
 	{
@@ -442,6 +591,18 @@ bool DDA::Init(GCodes::RawMove &nextMove, bool doMotorMapping)
 	// speed lower than the 0.5mm/sec minimum. We must apply the minimum speed first and then limit it if necessary after that.
 	requestedSpeed = min<float>(max<float>(reqSpeed, 0.5), VectorBoxIntersection(normalisedDirectionVector, reprap.GetPlatform().MaxFeedrates(), DRIVES));
 
+#if SUPPORT_NATIVE_ARCS
+	if (isArcMove)
+	{
+		// Limit the speed so that the centripetal acceleration doesn't exceed the acceleration limit
+		const float centripetalSpeedLimit = sqrtf(acceleration * arcRadius);
+		if (centripetalSpeedLimit < requestedSpeed)
+		{
+			requestedSpeed = max<float>(centripetalSpeedLimit, 0.5);
+		}
+	}
+#endif
+
 	// On a Cartesian printer, it is OK to limit the X and Y speeds and accelerations independently, and in consequence to allow greater values
 	// for diagonal moves. On a delta, this is not OK and any movement in the XY plane should be limited to the X/Y axis values, which we assume to be equal.
 	if (doMotorMapping)
@@ -449,6 +610,19 @@ bool DDA::Init(GCodes::RawMove &nextMove, bool doMotorMapping)
 		reprap.GetMove().GetKinematics().LimitSpeedAndAcceleration(*this, normalisedDirectionVector);	// give the kinematics the chance to further restrict the speed and acceleration
 	}
 
+#if SUPPORT_S_CURVE
+	// An S-curve phase takes as long and covers the same distance as a constant acceleration phase with the same mean acceleration, but its peak acceleration
+	// is higher. So plan the move with the mean acceleration reduced to keep the peak within the limit. Then the acceleration and deceleration phases
+	// take longer, and the distances and the move time that we calculate from here on are correct for the S-curve.
+	sCurvePlanned = reprap.GetPlatform().UseSCurveAcceleration();
+	if (sCurvePlanned)
+	{
+		acceleration /= SCurvePeakAccelerationRatio;
+	}
+#else
+	sCurvePlanned = false;
+#endif
+
 	// 7. Calculate the provisional accelerate and decelerate distances and the top speed
 	endSpeed = 0.0;					// until the next move asks us to adjust it
 
@@ -462,7 +636,13 @@ bool DDA::Init(GCodes::RawMove &nextMove, bool doMotorMapping)
 		// Try to meld this move to the previous move to avoid stop/start
 		// Assuming that this move ends with zero speed, calculate the maximum possible starting speed: u^2 = v^2 - 2as
 		prev->targetNextSpeed = min<float>(sqrtf(acceleration * totalDistance * 2.0), requestedSpeed);
+#if DDA_TIMING_STATS
+		const uint32_t lookaheadStartTime = Platform::GetInterruptClocks();
+		DoLookahead(prev);
+		lookaheadStats.Add(Platform::GetInterruptClocks() - lookaheadStartTime);
+#else
 		DoLookahead(prev);
+#endif
 		startSpeed = prev->endSpeed;
 	}
 
@@ -512,6 +692,8 @@ bool DDA::Init(const float_t adjustments[DRIVES])
 	// 3. Store some values
 	isLeadscrewAdjustmentMove = true;
 	isDeltaMovement = false;
+	isArcMove = false;
+	sCurvePlanned = false;
 	isPrintingMove = false;
 	xyMoving = false;
 	endStopsToCheck = 0;
@@ -610,9 +792,20 @@ pre(state == provisional)
 				if (laDDA->prev->state == provisional && laDDA->prev->isPrintingMove == laDDA->isPrintingMove && laDDA->prev->xyMoving == laDDA->xyMoving)
 				{
 					laDDA->MatchSpeeds();
-					const float maxStartSpeed = sqrtf(fsquare(laDDA->targetNextSpeed) + (2 * laDDA->acceleration * laDDA->totalDistance));
-					laDDA->prev->targetNextSpeed = min<float>(maxStartSpeed, laDDA->requestedSpeed);
-					// leave 'recurse' true
+					if (laDDA->targetNextSpeed <= laDDA->endSpeed)
+					{
+						// We can't increase the end speed of this move, so neither its start speed nor any earlier move needs to change.
+						// Stopping here keeps the cost of adding a move proportional to the number of moves whose speeds actually change,
+						// instead of walking back through every deceleration-only move in the queue each time.
+						laDDA->targetNextSpeed = laDDA->endSpeed;
+						goingUp = false;
+					}
+					else
+					{
+						const float maxStartSpeed = sqrtf(fsquare(laDDA->targetNextSpeed) + (2 * laDDA->acceleration * laDDA->totalDistance));
+						laDDA->prev->targetNextSpeed = min<float>(maxStartSpeed, laDDA->requestedSpeed);
+						// leave 'recurse' true
+					}
 				}
 				else
 				{
@@ -697,7 +890,7 @@ float DDA::AdvanceBabyStepping(float amount)
 	while(cdda != this)
 	{
 		float babySteppingToDo = 0.0;
-		if (amount != 0.0 && cdda->xyMoving)
+		if (amount != 0.0 && cdda->xyMoving && !cdda->isArcMove)		// arc moves need their direction vectors to stay tangential to the arc
 		{
 			// If not on a delta printer, check that we have a DM for the Z axis
 			bool ok = (cdda->isDeltaMovement || cdda->pddm[Z_AXIS] != nullptr);
@@ -848,6 +1041,11 @@ void DDA::RecalculateMove()
 					DebugPrint();
 				}
 			}
+			if (newAcceleration > acceleration)
+			{
+				// The S-curve peak would exceed the limit that we planned for, so use constant acceleration for this move
+				sCurvePlanned = false;
+			}
 			acceleration = newAcceleration;
 		}
 	}
@@ -864,7 +1062,7 @@ void DDA::RecalculateMove()
 		const Platform& p = reprap.GetPlatform();
 		for (size_t drive = 0; drive < DRIVES; ++drive)
 		{
-			if (pddm[drive] != nullptr && pddm[drive]->state == DMState::moving && endSpeed * fabsf(directionVector[drive]) > p.ActualInstantDv(drive))
+			if (pddm[drive] != nullptr && pddm[drive]->state == DMState::moving && endSpeed * fabsf(EndDirection(drive)) > p.ActualInstantDv(drive))
 			{
 				canPauseAfter = false;
 				break;
@@ -894,15 +1092,52 @@ void DDA::MatchSpeeds()
 		return;
 	}
 
-	for (size_t drive = 0; drive < DRIVES; ++drive)
+	// If junction deviation is configured and both moves involve XY movement, limit the cornering speed of the XYZ axes using the angle between the two moves.
+	// The direction vectors of both moves are unit length in XYZ, so the dot product is the cosine of the angle between them.
+	// We don't use it for reversals, because the junction speed would be zero; the instantaneous speed change limits handle those better.
+	const Platform& platform = reprap.GetPlatform();
+	const float junctionDeviation = platform.GetJunctionDeviation();
+	size_t firstDriveToCheck = 0;
+	if (junctionDeviation > 0.0 && xyMoving && next->xyMoving)
+	{
+		const float cosTheta = -(  EndDirection(X_AXIS) * next->directionVector[X_AXIS]
+								 + EndDirection(Y_AXIS) * next->directionVector[Y_AXIS]
+								 + directionVector[Z_AXIS] * next->directionVector[Z_AXIS]);
+		const float sinHalfTheta = sqrtf(max<float>(0.5 * (1.0 - cosTheta), 0.0));
+		// For a reversal sinHalfTheta is close to zero. We leave firstDriveToCheck at zero so that the instantaneous speed change limits of all the drives apply.
+		if (sinHalfTheta < 0.999)											// if not effectively a straight line
+		{
+			if (sinHalfTheta > 0.0001)										// if not effectively a reversal
+			{
+				const float junctionSpeed = sqrtf(min<float>(acceleration, next->acceleration) * junctionDeviation * sinHalfTheta/(1.0 - sinHalfTheta));
+				firstDriveToCheck = XYZ_AXES;								// the junction speed limits the XYZ axes instead of their jerk limits
+				if (targetNextSpeed > junctionSpeed)
+				{
+					targetNextSpeed = junctionSpeed;
+					if (targetNextSpeed < endSpeed)
+					{
+						reprap.GetMove().RecordLookaheadError();
+						if (reprap.Debug(moduleMove))
+						{
+							debugPrintf("DDA.cpp(%d) tn=%.3f ", __LINE__, (double)targetNextSpeed);
+							DebugPrint();
+						}
+						return;
+					}
+				}
+			}
+		}
+	}
+
+	for (size_t drive = firstDriveToCheck; drive < DRIVES; ++drive)
 	{
 		if (   (pddm[drive] != nullptr && pddm[drive]->state == DMState::moving)
 			|| (next->pddm[drive] != nullptr && next->pddm[drive]->state == DMState::moving)
 		   )
 		{
-			const float totalFraction = fabsf(directionVector[drive] - next->directionVector[drive]);
+			const float totalFraction = fabsf(EndDirection(drive) - next->directionVector[drive]);
 			const float jerk = totalFraction * targetNextSpeed;
-			const float allowedJerk = reprap.GetPlatform().ActualInstantDv(drive);
+			const float allowedJerk = platform.ActualInstantDv(drive);
 			if (jerk > allowedJerk)
 			{
 				targetNextSpeed = allowedJerk/totalFraction;
@@ -981,6 +1216,10 @@ pre(disableDeltaMapping || drive < MaxAxes)
 // This must not be called with interrupts disabled, because it calls Platform::EnableDrive.
 void DDA::Prepare(uint8_t simMode)
 {
+#if DDA_TIMING_STATS
+	const uint32_t prepareStartTime = Platform::GetInterruptClocks();
+#endif
+
 	PrepParams params;
 	params.decelStartDistance = totalDistance - decelDistance;
 
@@ -1000,8 +1239,42 @@ void DDA::Prepare(uint8_t simMode)
 			params.a2b2D2 = params.a2plusb2 * params.diagonalSquared;
 		}
 
+		const size_t numAxes = reprap.GetGCodes().GetTotalAxes();
+
+#if DDA_PHASE_PROFILES
+		// Decide whether the acceleration and deceleration phases use the S-curve profile or input shaping instead of constant acceleration.
+		// Homing moves may have their speed reduced part way through, which the profiled step time calculations don't support.
+		// The pressure advance calculations assume constant acceleration, so if any extruder is using it we use the trapezoidal profile.
+		profiledAccel = profiledDecel = shapeAccel = shapeDecel = false;
+		bool canProfile = endStopsToCheck == 0 && !isLeadscrewAdjustmentMove;
+		if (canProfile && usePressureAdvance)
+		{
+			for (size_t drive = numAxes; drive < DRIVES; ++drive)
+			{
+				if (pddm[drive] != nullptr && directionVector[drive] > 0.0 && reprap.GetPlatform().GetPressureAdvance(drive - numAxes) > 0.0)
+				{
+					canProfile = false;
+					break;
+				}
+			}
+		}
+# if SUPPORT_INPUT_SHAPING
+		// Input shaping takes precedence over the S-curve profile. It may lower the top speed and lengthen the acceleration and deceleration phases.
+		InputShaper& shaper = reprap.GetMove().GetShaper();
+		if (canProfile && shaper.IsActive())
+		{
+			PlanShapedPhases(shaper);
+			params.decelStartDistance = totalDistance - decelDistance;
+		}
+# endif
+#endif
+
 		// Convert the accelerate/decelerate distances to times
+#if SUPPORT_INPUT_SHAPING
+		const float accelStopTime = (shapeAccel) ? (float)accelClocks/stepClockRate : (topSpeed - startSpeed)/acceleration;
+#else
 		const float accelStopTime = (topSpeed - startSpeed)/acceleration;
+#endif
 		const float decelStartTime = accelStopTime + (params.decelStartDistance - accelDistance)/topSpeed;
 
 		startSpeedTimesCdivA = (uint32_t)roundU32((startSpeed * stepClockRate)/acceleration);
@@ -1012,7 +1285,35 @@ void DDA::Prepare(uint8_t simMode)
 
 		firstDM = nullptr;
 
-		const size_t numAxes = reprap.GetGCodes().GetTotalAxes();
+#if DDA_PHASE_PROFILES
+		if (canProfile)
+		{
+			endSpeedTimesCdivA = (uint32_t)roundU32((endSpeed * stepClockRate)/acceleration);
+			topSpeedTimesCdivA = params.topSpeedTimesCdivA;
+# if SUPPORT_INPUT_SHAPING
+			if (shaper.IsActive())
+			{
+				profiledAccel = shapeAccel;										// PlanShapedPhases has set up the phase times of shaped phases
+				profiledDecel = shapeDecel;
+			}
+			else
+# endif
+			{
+				accelClocks = params.topSpeedTimesCdivA - startSpeedTimesCdivA;
+				decelClocks = params.topSpeedTimesCdivA - endSpeedTimesCdivA;
+# if SUPPORT_S_CURVE
+				// We only use the S-curve profile if the move was planned for it, because its peak acceleration is SCurvePeakAccelerationRatio times the mean.
+				// Check each phase using the phase time that we will actually use, allowing one clock for rounding, so that the peak never exceeds the limit.
+				if (sCurvePlanned)
+				{
+					profiledAccel = (topSpeed - startSpeed) * (float)stepClockRate <= acceleration * (float)(accelClocks + 1);
+					profiledDecel = (topSpeed - endSpeed) * (float)stepClockRate <= acceleration * (float)(decelClocks + 1);
+				}
+# endif
+			}
+			twoCsquaredTimesTotalDistanceDivA = roundU64(((double)totalDistance * (double)(stepClockRateSquared * 2))/(double)acceleration);
+		}
+#endif
 		for (size_t drive = 0; drive < DRIVES; ++drive)
 		{
 			DriveMovement* const pdm = pddm[drive];
@@ -1058,6 +1359,12 @@ void DDA::Prepare(uint8_t simMode)
 							DebugPrintAll();
 						}
 					}
+#if SUPPORT_NATIVE_ARCS
+					else if (pdm->isArcAxis)
+					{
+						pdm->PrepareArcAxis(*this);
+					}
+#endif
 					else
 					{
 						pdm->PrepareCartesianAxis(*this, params);
@@ -1108,6 +1415,10 @@ void DDA::Prepare(uint8_t simMode)
 		m.flags = flags;
 		savedMovePointer = (savedMovePointer + 1) % NumSavedMoves;
 #endif
+
+#if DDA_TIMING_STATS
+		prepareStats.Add(Platform::GetInterruptClocks() - prepareStartTime);
+#endif
 	}
 
 	state = frozen;					// must do this last so that the ISR doesn't start executing it before we have finished setting it up
@@ -1134,6 +1445,160 @@ void DDA::Prepare(uint8_t simMode)
 	return magnitude;
 }
 
+#if DDA_PHASE_PROFILES
+
+// Return the time in step clocks from the start of the move at which the profiled acceleration phase reaches distance 'x'.
+// The distance is in units of acceleration/(2 * stepClockRate^2) mm, the same as the DM step time calculations use.
+float DDA::AccelPhaseClocks(float x, float estimate) const
+{
+#if SUPPORT_INPUT_SHAPING
+	if (shapeAccel)
+	{
+		return reprap.GetMove().GetShaper().SolvePhase(x, (float)startSpeedTimesCdivA, (float)(topSpeedTimesCdivA - startSpeedTimesCdivA), (float)accelClocks, false, estimate);
+	}
+#endif
+#if SUPPORT_S_CURVE
+	return SolveSCurvePhase(x, (float)startSpeedTimesCdivA, (float)accelClocks, estimate);
+#else
+	return 0.0;						// we only get here if the phase is profiled, so this is not reached
+#endif
+}
+
+// Return the time in step clocks from the start of the move at which the profiled deceleration phase is 'remainingX' from the end of the move
+float DDA::DecelPhaseClocks(float remainingX, float estimate) const
+{
+#if SUPPORT_INPUT_SHAPING
+	if (shapeDecel)
+	{
+		// Shaped deceleration is not symmetrical in time, so we solve it forwards from the start of the deceleration phase.
+		// A shaped phase covers the same distance as it would at constant acceleration over the same time.
+		const float decelStartClocks = (float)clocksNeeded - (float)decelClocks;
+		const float decelX = (float)decelClocks * (float)(endSpeedTimesCdivA + topSpeedTimesCdivA);
+		return decelStartClocks
+				+ reprap.GetMove().GetShaper().SolvePhase(decelX - remainingX, (float)topSpeedTimesCdivA, (float)(topSpeedTimesCdivA - endSpeedTimesCdivA), (float)decelClocks, true,
+															(estimate < 0.0) ? -1.0 : max<float>(estimate - decelStartClocks, 0.0));
+	}
+#endif
+#if SUPPORT_S_CURVE
+	// The S-curve deceleration phase is an acceleration phase from the end speed, reversed in time
+	const float timeLeftEstimate = (estimate < 0.0) ? -1.0 : max<float>((float)clocksNeeded - estimate, 0.0);
+	return (float)clocksNeeded - SolveSCurvePhase(remainingX, (float)endSpeedTimesCdivA, (float)decelClocks, timeLeftEstimate);
+#else
+	return (float)clocksNeeded;		// we only get here if the phase is profiled, so this is not reached
+#endif
+}
+
+#endif
+
+#if SUPPORT_INPUT_SHAPING
+
+// Return the distance that shaped acceleration and deceleration phases would cover if the move had top speed 'v', and the phase times in step clocks
+float DDA::ShapedPhasesDistance(const InputShaper& shaper, float v, float& accelTime, float& decelTime) const
+{
+	const float cDivA = (float)stepClockRate/acceleration;
+	accelTime = (v > startSpeed) ? ceilf(shaper.GetPhaseClocks((v - startSpeed) * cDivA)) : 0.0;
+	decelTime = (v > endSpeed) ? ceilf(shaper.GetPhaseClocks((v - endSpeed) * cDivA)) : 0.0;
+	return (0.5 * (startSpeed + v) * accelTime + 0.5 * (v + endSpeed) * decelTime)/stepClockRate;
+}
+
+// Lengthen the acceleration and deceleration phases so that when we shape them, the peak acceleration is no more than the acceleration we planned with.
+// We keep the start and end speeds because the adjacent moves depend on them, so if the longer phases don't fit in the move we lower the top speed.
+// If they don't fit even with no steady speed phase, we leave the move with the constant acceleration phases we planned, and count it.
+void DDA::PlanShapedPhases(InputShaper& shaper)
+{
+	constexpr unsigned int MaxIterations = 16;
+
+	float accelTime, decelTime;
+	if (ShapedPhasesDistance(shaper, topSpeed, accelTime, decelTime) > totalDistance)
+	{
+		// Find the highest top speed at which the phases fit by bisection, keeping 'low' at a speed at which they fit
+		float low = max<float>(startSpeed, endSpeed), high = topSpeed;
+		if (ShapedPhasesDistance(shaper, low, accelTime, decelTime) > totalDistance)
+		{
+			shaper.RecordMove(false);
+			return;
+		}
+		for (unsigned int i = 0; i < MaxIterations; ++i)
+		{
+			const float v = 0.5 * (low + high);
+			if (ShapedPhasesDistance(shaper, v, accelTime, decelTime) > totalDistance)
+			{
+				high = v;
+			}
+			else
+			{
+				low = v;
+			}
+		}
+		topSpeed = low;
+		(void)ShapedPhasesDistance(shaper, topSpeed, accelTime, decelTime);
+	}
+
+	accelDistance = 0.5 * (startSpeed + topSpeed) * accelTime/stepClockRate;
+	decelDistance = 0.5 * (topSpeed + endSpeed) * decelTime/stepClockRate;
+	accelClocks = (uint32_t)accelTime;
+	decelClocks = (uint32_t)decelTime;
+	shapeAccel = (accelClocks != 0);
+	shapeDecel = (decelClocks != 0);
+	clocksNeeded = accelClocks + decelClocks + (uint32_t)((max<float>(totalDistance - accelDistance - decelDistance, 0.0)/topSpeed) * stepClockRate);
+	if (shapeAccel || shapeDecel)
+	{
+		shaper.RecordMove(true);
+	}
+}
+
+#endif
+
+#if SUPPORT_S_CURVE
+
+// Return the time in step clocks at which an S-curve acceleration phase has covered distance 'x', where 'x' is in units of acceleration/(2 * stepClockRate^2) mm.
+// 'initialSpeed' is the speed at the start of the phase multiplied by stepClockRate/acceleration, and 'phaseClocks' is the duration of the phase.
+// In the S-curve profile the speed follows the polynomial 10f^3 - 15f^4 + 6f^5 of the fraction f of the phase completed, so the phase takes the same time
+// and covers the same distance as it would at constant acceleration, but the acceleration rises smoothly from zero and falls back to zero at the end.
+// The peak acceleration is SCurvePeakAccelerationRatio times the nominal acceleration, so DDA::Init reduces the nominal acceleration by that ratio.
+// 'estimate' is an estimate of the result, or negative if we don't have one. We use Newton-Raphson iteration starting from the estimate, falling back to
+// bisection when a step would take us outside the interval known to contain the result. Normally this converges in one or two iterations.
+/*static*/ float DDA::SolveSCurvePhase(float x, float initialSpeed, float phaseClocks, float estimate)
+{
+	constexpr unsigned int MaxIterations = 16;
+
+	if (x <= 0.0 || phaseClocks <= 0.0)
+	{
+		return 0.0;
+	}
+
+	float low = 0.0, high = phaseClocks;
+	float t = (estimate < 0.0) ? 0.5 * phaseClocks : min<float>(estimate, phaseClocks);
+	for (unsigned int i = 0; i < MaxIterations; ++i)
+	{
+		const float f = t/phaseClocks;
+		const float fCubed = f * f * f;
+		const float error = 2.0 * (initialSpeed * t + phaseClocks * phaseClocks * fCubed * f * (2.5 + f * (f - 3.0))) - x;
+		if (error > 0.0)
+		{
+			high = t;
+		}
+		else
+		{
+			low = t;
+		}
+		const float speed = 2.0 * (initialSpeed + phaseClocks * fCubed * (10.0 + f * (6.0 * f - 15.0)));
+		float newT = (speed > 0.0) ? t - error/speed : -1.0;
+		if (newT < low || newT > high)
+		{
+			newT = 0.5 * (low + high);
+		}
+		if (fabsf(newT - t) < 1.0)
+		{
+			return newT;
+		}
+		t = newT;
+	}
+	return t;
+}
+
+#endif
+
 // Normalise a vector with dim1 dimensions so that it is unit in the first dim2 dimensions, and also return its previous magnitude in dim2 dimensions
 /*static*/ float DDA::Normalise(float v[], size_t dim1, size_t dim2)
 {
@@ -1323,6 +1788,10 @@ pre(state == frozen)
 	moveStartTime = tim;
 	state = executing;
 
+#if DM_SCHEDULER_HEAP
+	dmHeapSize = 0;
+#endif
+
 #if DDA_LOG_PROBE_CHANGES
 	if ((endStopsToCheck & LogProbeChanges) != 0)
 	{
@@ -1388,7 +1857,17 @@ pre(state == frozen)
 
 		if (firstDM != nullptr)
 		{
+#if DM_SCHEDULER_HEAP
+			// The list is already in step time order, so copying it in order gives a valid heap
+			for (DriveMovement *dm = firstDM; dm != nullptr; dm = dm->nextDM)
+			{
+				dmHeap[dmHeapSize++] = dm;
+			}
+			firstDM = nullptr;
+			return platform.ScheduleStepInterrupt(dmHeap[0]->nextStepTime + moveStartTime);
+#else
 			return platform.ScheduleStepInterrupt(firstDM->nextStepTime + moveStartTime);
+#endif
 		}
 	}
 
@@ -1398,6 +1877,51 @@ pre(state == frozen)
 
 uint32_t DDA::maxReps = 0;		// this holds he maximum ISR loop count
 
+#if DDA_TIMING_STATS
+
+DdaTimingStats DDA::prepareStats;
+DdaTimingStats DDA::lookaheadStats;
+DdaTimingStats DDA::stepStats;
+DdaTimingStats DDA::stepWaitStats;
+uint32_t DDA::stepsGenerated = 0;
+uint32_t DDA::stepWaitClocksThisMove = 0;
+
+float DdaTimingStats::AverageMicroseconds() const
+{
+	return (count == 0) ? 0.0 : ((float)totalClocks * 1000000.0)/((float)count * DDA::stepClockRate);
+}
+
+float DdaTimingStats::MaxMicroseconds() const
+{
+	return ((float)maxClocks * 1000000.0)/(float)DDA::stepClockRate;
+}
+
+// Print the timing statistics and reset them. The resolution is one step clock, so short times are only approximate.
+/*static*/ void DDA::PrintTimingStats(MessageType mtype)
+{
+	// The step ISR updates some of these, so copy and clear them with interrupts disabled
+	const irqflags_t flags = cpu_irq_save();
+	const DdaTimingStats prepare = prepareStats, lookahead = lookaheadStats, step = stepStats, stepWait = stepWaitStats;
+	const uint32_t steps = stepsGenerated;
+	prepareStats.Reset();
+	lookaheadStats.Reset();
+	stepStats.Reset();
+	stepWaitStats.Reset();
+	stepsGenerated = 0;
+	cpu_irq_restore(flags);
+
+	const float stepAverage = (steps == 0) ? 0.0 : ((float)step.totalClocks * 1000000.0)/((float)steps * stepClockRate);
+	reprap.GetPlatform().MessageF(mtype,
+			"Timing (us): Prepare max %.1f avg %.1f over %" PRIu32 " moves, lookahead max %.1f avg %.1f, step ISR max %.1f avg %.1f, per step %.2f over %" PRIu32 " steps\n",
+			(double)prepare.MaxMicroseconds(), (double)prepare.AverageMicroseconds(), prepare.count,
+			(double)lookahead.MaxMicroseconds(), (double)lookahead.AverageMicroseconds(),
+			(double)step.MaxMicroseconds(), (double)step.AverageMicroseconds(), (double)stepAverage, steps);
+	reprap.GetPlatform().MessageF(mtype, "Step pulse wait per move (us): max %.1f avg %.1f over %" PRIu32 " moves\n",
+			(double)stepWait.MaxMicroseconds(), (double)stepWait.AverageMicroseconds(), stepWait.count);
+}
+
+#endif
+
 // This is called by the interrupt service routine to execute steps.
 // It returns true if it needs to be called again on the DDA of the new current move, otherwise false.
 // This must be as fast as possible, because it determines the maximum movement speed.
@@ -1406,6 +1930,9 @@ bool DDA::Step()
 {
 	Platform& platform = reprap.GetPlatform();
 	uint32_t lastStepPulseTime = platform.GetInterruptClocks();
+#if DDA_TIMING_STATS
+	const uint32_t isrStartTime = lastStepPulseTime;
+#endif
 	bool repeat;
 	uint32_t numReps = 0;
 	do
@@ -1423,9 +1950,21 @@ bool DDA::Step()
 		}
 
 		// 2. Determine which drivers are due for stepping, overdue, or will be due very shortly
-		DriveMovement* dm = firstDM;
 		const uint32_t elapsedTime = (Platform::GetInterruptClocks() - moveStartTime) + minInterruptInterval;
 		uint32_t driversStepping = 0;
+#if DM_SCHEDULER_HEAP
+		DriveMovement *dueDMs[DRIVES];
+		size_t numDue = 0;
+		while (dmHeapSize != 0 && elapsedTime >= dmHeap[0]->nextStepTime)	// if the next step is due
+		{
+			++numReps;
+			DriveMovement * const dm = dmHeap[0];
+			RemoveDMAt(0);
+			driversStepping |= platform.GetDriversBitmap(dm->drive);
+			dueDMs[numDue++] = dm;
+		}
+#else
+		DriveMovement* dm = firstDM;
 		while (dm != nullptr && elapsedTime >= dm->nextStepTime)		// if the next step is due
 		{
 			++numReps;
@@ -1436,22 +1975,62 @@ bool DDA::Step()
 //if (t3 > maxCalcTime) maxCalcTime = t3;
 //if (t3 < minCalcTime) minCalcTime = t3;
 		}
+#endif
 
 		// 3. Step the drivers
 		if ((driversStepping & platform.GetSlowDrivers()) != 0)
 		{
-			while (Platform::GetInterruptClocks() - lastStepPulseTime < platform.GetSlowDriverClocks()) {}
-			Platform::StepDriversHigh(driversStepping);					// generate the steps
-			lastStepPulseTime = Platform::GetInterruptClocks();
+#if SUPPORT_TIMED_STEP_PULSES
+			if (platform.GetSlowDriverClocks() >= minInterruptInterval)
+			{
+				// The step pulse is long enough for the step timer to end it, so we don't need to wait for it here
+# if DDA_TIMING_STATS
+				stepWaitClocksThisMove += platform.WaitForSlowDriversReady();
+# else
+				(void)platform.WaitForSlowDriversReady();
+# endif
+				Platform::StepDriversHigh(driversStepping);				// generate the steps
+				platform.ScheduleSlowStepPinsLow(driversStepping & platform.GetSlowDrivers());
+			}
+			else
+#endif
+			{
+#if DDA_TIMING_STATS
+				const uint32_t waitStartTime = Platform::GetInterruptClocks();
+#endif
+				while (Platform::GetInterruptClocks() - lastStepPulseTime < platform.GetSlowDriverClocks()) {}
+				Platform::StepDriversHigh(driversStepping);				// generate the steps
+				lastStepPulseTime = Platform::GetInterruptClocks();
+#if DDA_TIMING_STATS
+				stepWaitClocksThisMove += lastStepPulseTime - waitStartTime;
+#endif
+			}
 		}
 		else
 		{
+#if SUPPORT_TIMED_STEP_PULSES
+			Platform::StepDriversHigh(driversStepping | platform.GetPendingSlowStepPins());	// generate the steps without ending any slow driver pulses early
+#else
 			Platform::StepDriversHigh(driversStepping);					// generate the steps
+#endif
 		}
 
 		// 4. Remove those drives from the list, calculate the next step times, update the direction pins where necessary,
 		//    and re-insert them so as to keep the list in step-time order. We assume that meeting the direction pin hold time
 		//    is not a problem for any driver type. This is not necessarily true.
+#if DM_SCHEDULER_HEAP
+		for (size_t i = 0; i < numDue; ++i)
+		{
+			DriveMovement * const dmToInsert = dueDMs[i];
+			const bool hasMoreSteps = (isDeltaMovement && dmToInsert->drive < DELTA_AXES)
+					? dmToInsert->CalcNextStepTimeDelta(*this, true)
+					: dmToInsert->CalcNextStepTimeCartesian(*this, true);
+			if (hasMoreSteps)
+			{
+				PushDM(dmToInsert);
+			}
+		}
+#else
 		DriveMovement *dmToInsert = firstDM;							// head of the chain we need to re-insert
 		firstDM = dm;													// remove the chain from the list
 		while (dmToInsert != dm)										// note that both of these may be nullptr
@@ -1466,13 +2045,27 @@ bool DDA::Step()
 			}
 			dmToInsert = nextToInsert;
 		}
+#endif
 
 		// 5. Reset all step pins low
+#if SUPPORT_TIMED_STEP_PULSES
+		if (platform.GetPendingSlowStepPins() != 0)
+		{
+			Platform::StepDriversHigh(platform.GetPendingSlowStepPins());	// set all step pins low except those that the step timer will set low
+		}
+		else
+#endif
 		if ((driversStepping & platform.GetSlowDrivers()) != 0)
 		{
+#if DDA_TIMING_STATS
+			const uint32_t waitStartTime = Platform::GetInterruptClocks();
+#endif
 			while (Platform::GetInterruptClocks() - lastStepPulseTime < platform.GetSlowDriverClocks()) {}
 			Platform::StepDriversLow();									// set all step pins low
 			lastStepPulseTime = Platform::GetInterruptClocks();
+#if DDA_TIMING_STATS
+			stepWaitClocksThisMove += lastStepPulseTime - waitStartTime;
+#endif
 		}
 		else
 		{
@@ -1480,14 +2073,15 @@ bool DDA::Step()
 		}
 
 		// 6. Check for move completed
-		if (firstDM == nullptr)
+		const DriveMovement * const nextDM = FirstDM();
+		if (nextDM == nullptr)
 		{
 			state = completed;
 			break;
 		}
 
 		// 7. Schedule next interrupt, or if it would be too soon, generate more steps immediately
-		repeat = platform.ScheduleStepInterrupt(firstDM->nextStepTime + moveStartTime);
+		repeat = platform.ScheduleStepInterrupt(nextDM->nextStepTime + moveStartTime);
 	} while (repeat);
 
 	if (numReps > maxReps)
@@ -1495,8 +2089,18 @@ bool DDA::Step()
 		maxReps = numReps;
 	}
 
+#if DDA_TIMING_STATS
+	stepStats.Add(Platform::GetInterruptClocks() - isrStartTime);
+	stepsGenerated += numReps;
+#endif
+
 	if (state == completed)
 	{
+#if DDA_TIMING_STATS
+		stepWaitStats.Add(stepWaitClocksThisMove);
+		stepWaitClocksThisMove = 0;
+#endif
+
 		// The following finish time is wrong if we aborted the move because of endstop or Z probe checks.
 		// However, following a move that checks endstops or the Z probe, we always wait for the move to complete before we schedule another, so this doesn't matter.
 		const uint32_t finishTime = moveStartTime + clocksNeeded;	// calculate how long this move should take
@@ -1521,7 +2125,7 @@ void DDA::StopDrive(size_t drive)
 			endCoordinatesValid = false;			// the XYZ position is no longer valid
 		}
 		RemoveDM(drive);
-		if (firstDM == nullptr)
+		if (FirstDM() == nullptr)
 		{
 			state = completed;
 		}
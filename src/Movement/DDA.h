@@ -18,6 +18,38 @@
 #define DDA_LOG_PROBE_CHANGES	0		// save memory on the wired Duet
 #endif
 
+#ifndef DDA_TIMING_STATS
+# define DDA_TIMING_STATS		0		// 1 to collect execution time statistics for Prepare, DoLookahead and Step. This slows down the step ISR.
+#endif
+
+// The step ISR needs to find the DM with the earliest step due. With 0 the DMs of the executing move are kept in a linked list sorted by step time,
+// which is fastest when only a few drives are moving. With 1 they are kept in a binary heap, which scales better when many drives move at once
+// (e.g. mixing extruders), because inserting a DM costs O(log n) comparisons instead of O(n).
+#define DM_SCHEDULER_HEAP		0
+
+#define DDA_PHASE_PROFILES		(SUPPORT_S_CURVE || SUPPORT_INPUT_SHAPING)	// true if the acceleration and deceleration phases need not have constant acceleration
+
+#if SUPPORT_INPUT_SHAPING
+class InputShaper;
+#endif
+
+#if DDA_TIMING_STATS
+
+// Structure to accumulate the execution times of one of the movement functions, in step clocks
+struct DdaTimingStats
+{
+	uint64_t totalClocks;
+	uint32_t maxClocks;
+	uint32_t count;
+
+	void Reset() { totalClocks = 0; maxClocks = 0; count = 0; }
+	void Add(uint32_t clocks) __attribute__ ((hot));
+	float AverageMicroseconds() const;
+	float MaxMicroseconds() const;
+};
+
+#endif
+
 /**
  * This defines a single linear movement of the print head
  */
@@ -52,6 +84,7 @@ public:
 	bool CanPauseAfter() const { return canPauseAfter; }
 	bool CanPauseBefore() const { return canPauseBefore; }
 	bool IsPrintingMove() const { return isPrintingMove; }			// Return true if this involves both XY movement and extrusion
+	bool IsXYMoving() const { return xyMoving; }					// Return true if this involves XY movement
 
 	DDAState GetState() const { return state; }
 	DDA* GetNext() const { return next; }
@@ -96,6 +129,9 @@ public:
 
 	static constexpr uint32_t stepClockRate = VARIANT_MCK/128;				// the frequency of the clock used for stepper pulse timing (see Platform::InitialiseInterrupts)
 	static constexpr uint64_t stepClockRateSquared = (uint64_t)stepClockRate * stepClockRate;
+#if SUPPORT_S_CURVE
+	static constexpr float SCurvePeakAccelerationRatio = 1.875;			// the peak acceleration of an S-curve phase divided by its mean acceleration
+#endif
 
 	// Note on the following constant:
 	// If we calculate the step interval on every clock, we reach a point where the calculation time exceeds the step interval.
@@ -128,6 +164,17 @@ public:
 
 	static uint32_t maxReps;
 
+#if DDA_TIMING_STATS
+	static void PrintTimingStats(MessageType mtype);				// print the timing statistics and reset them
+
+	static DdaTimingStats prepareStats;								// execution time of Prepare per move
+	static DdaTimingStats lookaheadStats;							// execution time of DoLookahead per new move
+	static DdaTimingStats stepStats;								// execution time of Step per step interrupt
+	static DdaTimingStats stepWaitStats;							// time spent in Step waiting for slow driver step pulse timing, per move
+	static uint32_t stepsGenerated;									// number of steps generated by Step since the statistics were reset
+	static uint32_t stepWaitClocksThisMove;							// time spent waiting for slow driver step pulse timing during the current move
+#endif
+
 private:
 	DriveMovement *FindDM(size_t drive) const;
 	void RecalculateMove() __attribute__ ((hot));
@@ -136,13 +183,30 @@ private:
 	void StopDrive(size_t drive);									// stop movement of a drive and recalculate the endpoint
 	void InsertDM(DriveMovement *dm) __attribute__ ((hot));
 	void RemoveDM(size_t drive);
+	DriveMovement *FirstDM() const __attribute__ ((hot));			// return the DM with the earliest step due, or nullptr if none
 	void ReleaseDMs();
 	bool IsDecelerationMove() const;								// return true if this move is or have been might have been intended to be a deceleration-only move
 	void DebugPrintVector(const char *name, const float *vec, size_t len) const;
 	void CheckEndstops(Platform& platform);
 	float NormaliseXYZ();											// Make the direction vector unit-normal in XYZ
+	float EndDirection(size_t drive) const;							// Get a component of the direction vector at the end of the move
+#if DDA_PHASE_PROFILES
+	float AccelPhaseClocks(float x, float estimate) const __attribute__ ((hot));			// Get the time at which a profiled acceleration phase reaches a distance
+	float DecelPhaseClocks(float remainingX, float estimate) const __attribute__ ((hot));	// Get the time at which a profiled deceleration phase is a distance from the end
+#endif
+#if SUPPORT_INPUT_SHAPING
+	void PlanShapedPhases(InputShaper& shaper);						// Lengthen the acceleration and deceleration phases so that we can shape them
+	float ShapedPhasesDistance(const InputShaper& shaper, float v, float& accelTime, float& decelTime) const;
+#endif
 
 	static void DoLookahead(DDA *laDDA) __attribute__ ((hot));		// Try to smooth out moves in the queue
+#if DM_SCHEDULER_HEAP
+	static void PushDM(DriveMovement *dm) __attribute__ ((hot));	// add a DM to the step heap
+	static void RemoveDMAt(size_t index) __attribute__ ((hot));		// remove the DM at the specified position from the step heap
+#endif
+#if SUPPORT_S_CURVE
+	static float SolveSCurvePhase(float x, float initialSpeed, float phaseClocks, float estimate) __attribute__ ((hot));
+#endif
     static float Normalise(float v[], size_t dim1, size_t dim2);  	// Normalise a vector of dim1 dimensions to unit length in the first dim1 dimensions
     static void Absolute(float v[], size_t dimensions);				// Put a vector in the positive hyperquadrant
     static float Magnitude(const float v[], size_t dimensions);  	// Return the length of a vector
@@ -169,6 +233,12 @@ private:
 			uint8_t xyMoving : 1;					// True if movement along an X axis or the Y axis was requested, even it if's too small to do
 			uint8_t goingSlow : 1;					// True if we have slowed the movement because the Z probe is approaching its threshold
 			uint8_t isLeadscrewAdjustmentMove : 1;	// True if this is a leadscrews adjustment move
+			uint8_t isArcMove : 1;					// True if this is an arc move in which the X and Y motors follow a circle
+			uint8_t profiledAccel : 1;				// True if the acceleration phase uses the S-curve profile or input shaping instead of constant acceleration
+			uint8_t profiledDecel : 1;				// True if the deceleration phase uses the S-curve profile or input shaping instead of constant acceleration
+			uint8_t shapeAccel : 1;					// True if the acceleration phase uses input shaping
+			uint8_t shapeDecel : 1;					// True if the deceleration phase uses input shaping
+			uint8_t sCurvePlanned : 1;				// True if the acceleration was reduced so that the S-curve profile can be used without exceeding the limit
 		};
 		uint16_t flags;								// so that we can print all the flags at once for debugging
 	};
@@ -190,6 +260,14 @@ private:
     // These are used only in delta calculations
     int32_t cKc;							// The Z movement fraction multiplied by Kc and converted to integer
 
+#if SUPPORT_NATIVE_ARCS
+    // These are used only in arc moves. The direction vector holds the direction at the start of the arc.
+    float arcRadius;						// The radius of the arc
+    float arcStartAngle;					// The angle of the start point from the centre of the arc
+    float arcTotalAngle;					// The angle moved, positive for anticlockwise arcs
+    float arcEndDirection[2];				// The X and Y components of the direction vector at the end of the arc
+#endif
+
     // These vary depending on how we connect the move with its predecessor and successor, but remain constant while the move is being executed
 	float startSpeed;
 	float endSpeed;
@@ -206,6 +284,13 @@ private:
 	uint32_t startSpeedTimesCdivA;			// the number of clocks it would have taken t reach the start speed form rest
 	uint32_t topSpeedTimesCdivAPlusDecelStartClocks;
 	int32_t extraAccelerationClocks;		// the additional number of clocks needed because we started the move at less than topSpeed. Negative after ReduceHomingSpeed has been called.
+#if DDA_PHASE_PROFILES
+	uint64_t twoCsquaredTimesTotalDistanceDivA;	// the total distance in the units used by the profiled phase step time calculations
+	uint32_t endSpeedTimesCdivA;			// the number of clocks it would take to decelerate from the end speed to rest
+	uint32_t topSpeedTimesCdivA;			// the number of clocks it would take to decelerate from the top speed to rest
+	uint32_t accelClocks;					// the duration of the acceleration phase
+	uint32_t decelClocks;					// the duration of the deceleration phase
+#endif
 
 	float proportionLeft;					// what proportion of the extrusion in the G1 or G0 move of which this is a part remains to be done after this segment is complete
 
@@ -221,6 +306,12 @@ private:
 
     DriveMovement* firstDM;					// list of contained DMs that need steps, in step time order
 	DriveMovement *pddm[DRIVES];			// These describe the state of each drive movement
+
+#if DM_SCHEDULER_HEAP
+	// Only one move executes at a time, so the heap is shared between all DDAs. Start() fills it from the firstDM list built by Prepare().
+	static DriveMovement *dmHeap[DRIVES];	// DMs of the executing move that need steps, as a binary min-heap ordered by step time
+	static size_t dmHeapSize;				// number of entries in dmHeap
+#endif
 };
 
 // Find the DriveMovement record for a given drive, or return nullptr if there isn't one
@@ -229,6 +320,16 @@ inline DriveMovement *DDA::FindDM(size_t drive) const
 	return pddm[drive];
 }
 
+// Return the DM of the executing move that has the earliest step due, or nullptr if there isn't one
+inline DriveMovement *DDA::FirstDM() const
+{
+#if DM_SCHEDULER_HEAP
+	return (dmHeapSize == 0) ? nullptr : dmHeap[0];
+#else
+	return firstDM;
+#endif
+}
+
 // Force an end point
 inline void DDA::SetDriveCoordinate(int32_t a, size_t drive)
 {
@@ -236,6 +337,18 @@ inline void DDA::SetDriveCoordinate(int32_t a, size_t drive)
 	endCoordinatesValid = false;
 }
 
+// Get a component of the direction vector at the end of the move. This differs from the direction vector only for the X and Y axes of an arc move.
+inline float DDA::EndDirection(size_t drive) const
+{
+#if SUPPORT_NATIVE_ARCS
+	if (isArcMove && drive <= Y_AXIS)
+	{
+		return arcEndDirection[drive];
+	}
+#endif
+	return directionVector[drive];
+}
+
 #if HAS_SMART_DRIVERS
 
 // Get the current full step interval for this axis or extruder
@@ -247,4 +360,18 @@ inline uint32_t DDA::GetStepInterval(size_t axis, uint32_t microstepShift) const
 
 #endif
 
+#if DDA_TIMING_STATS
+
+inline void DdaTimingStats::Add(uint32_t clocks)
+{
+	totalClocks += clocks;
+	if (clocks > maxClocks)
+	{
+		maxClocks = clocks;
+	}
+	++count;
+}
+
+#endif
+
 #endif /* DDA_H_ */
@@ -17,13 +17,16 @@
 DriveMovement *DriveMovement::freeList = nullptr;
 int DriveMovement::numFree = 0;
 int DriveMovement::minFree = 0;
+int DriveMovement::numTotal = 0;
 
+// Allocate some DMs. This is called at startup, and again if the movement queue length is increased.
 void DriveMovement::InitialAllocate(unsigned int num)
 {
 	while (num != 0)
 	{
 		freeList = new DriveMovement(freeList);
 		++numFree;
+		++numTotal;
 		--num;
 	}
 	ResetMinFree();
@@ -43,6 +46,7 @@ DriveMovement *DriveMovement::Allocate(size_t drive, DMState st)
 		dm->nextDM = nullptr;
 		dm->drive = (uint8_t)drive;
 		dm->state = st;
+		dm->isArcAxis = false;
 	}
 	return dm;
 }
@@ -250,6 +254,210 @@ void DriveMovement::PrepareExtruder(const DDA& dda, const PrepParams& params, bo
 	}
 }
 
+#if SUPPORT_NATIVE_ARCS
+
+// Arc moves on Cartesian printers. The position of each of the X and Y motors in steps relative to the start is centre + radius * cos(phase),
+// where the phase is the angle around the arc, less PI/2 for the Y axis. Between consecutive multiples of PI the motor moves in one direction,
+// so we divide the arc into pieces at those points and reverse the motor between pieces. Within a piece we find the phase at which the next step
+// is due using acosf, then convert the distance along the path to a time using the acceleration, steady speed and deceleration phases of the move.
+// A step is due when the motor position passes half way between two step positions.
+
+// Set up this DM for the X or Y axis of an arc move. 'phaseOffset' is 0 for the X axis and PI/2 for the Y axis.
+// Set totalSteps to the total number of steps including reversals, and return the net number of steps moved.
+int32_t DriveMovement::InitArcAxis(const DDA& dda, float stepsPerMm, float phaseOffset)
+{
+	isArcAxis = true;
+	mp.arc.radius = dda.arcRadius * stepsPerMm;
+	mp.arc.phaseStart = dda.arcStartAngle - phaseOffset;
+	mp.arc.centre = -mp.arc.radius * cosf(mp.arc.phaseStart);
+
+	// Count the steps in each piece of the arc
+	const int32_t pieceIncrement = (dda.arcTotalAngle >= 0.0) ? 1 : -1;
+	mp.arc.currentLevel = 0;
+	totalSteps = 0;
+	for (int32_t piece = FirstArcPiece(dda); ; piece += pieceIncrement)
+	{
+		const bool isLastPiece = SetArcPiece(dda, piece);
+		totalSteps += mp.arc.pieceSteps;
+		mp.arc.currentLevel += (direction) ? (int32_t)mp.arc.pieceSteps : -(int32_t)mp.arc.pieceSteps;
+		if (isLastPiece)
+		{
+			break;
+		}
+	}
+
+	mp.arc.netSteps = mp.arc.currentLevel;
+	return mp.arc.netSteps;
+}
+
+// Prepare this DM for the X or Y axis of an arc move
+void DriveMovement::PrepareArcAxis(const DDA& dda)
+{
+	mp.arc.mmPerRadian = dda.totalDistance/fabsf(dda.arcTotalAngle);
+	mp.arc.currentLevel = 0;
+	mp.arc.pieceFirstStep = 1;
+	(void)SetArcPiece(dda, FirstArcPiece(dda));
+	reverseStartStep = totalSteps + 1;								// we handle reversals differently, but this keeps the debug print tidy
+}
+
+// Return the piece of the arc that the start point is in
+int32_t DriveMovement::FirstArcPiece(const DDA& dda) const
+{
+	return (dda.arcTotalAngle >= 0.0)
+			? (int32_t)floorf(mp.arc.phaseStart/PI)
+				: (int32_t)ceilf(mp.arc.phaseStart/PI) - 1;
+}
+
+// Make the specified piece of the arc the current one, setting the direction and the number of steps from the current position to the end of the piece.
+// Return true if this is the last piece of the arc.
+bool DriveMovement::SetArcPiece(const DDA& dda, int32_t piece)
+{
+	const bool anticlockwise = (dda.arcTotalAngle >= 0.0);
+	const float phaseEnd = mp.arc.phaseStart + dda.arcTotalAngle;
+	const float pieceBoundary = (anticlockwise) ? (piece + 1) * PI : piece * PI;
+	const bool isLastPiece = (anticlockwise) ? phaseEnd <= pieceBoundary : phaseEnd >= pieceBoundary;
+
+	// The cosine decreases with increasing phase in even-numbered pieces and increases in odd-numbered ones
+	mp.arc.piece = piece;
+	direction = ((piece & 1) == 0) != anticlockwise;
+	const int32_t endLevel = (int32_t)floorf(mp.arc.centre + mp.arc.radius * cosf((isLastPiece) ? phaseEnd : pieceBoundary) + 0.5);
+	mp.arc.pieceSteps = (uint32_t)labs(endLevel - mp.arc.currentLevel);
+	return isLastPiece;
+}
+
+// Calculate the time since the start of the move when the next step for the X or Y axis of an arc move is due.
+// Return true if there are more steps to do.
+bool DriveMovement::CalcNextStepTimeArcFull(const DDA &dda, bool live)
+pre(nextStep <= totalSteps; stepsTillRecalc == 0)
+{
+	// If we have done all the steps in the current piece of the arc, move on to the next piece that has some steps in it
+	if (nextStep >= mp.arc.pieceFirstStep + mp.arc.pieceSteps)
+	{
+		const bool oldDirection = direction;
+		const int32_t pieceIncrement = (dda.arcTotalAngle >= 0.0) ? 1 : -1;
+		do
+		{
+			mp.arc.pieceFirstStep += mp.arc.pieceSteps;
+			if (SetArcPiece(dda, mp.arc.piece + pieceIncrement) && nextStep >= mp.arc.pieceFirstStep + mp.arc.pieceSteps)
+			{
+				// We have run out of pieces before running out of steps, which should not happen
+				state = DMState::stepError;
+				stepInterval = 20000000;							// so we can tell what happened in the debug print
+				return false;
+			}
+		} while (nextStep >= mp.arc.pieceFirstStep + mp.arc.pieceSteps);
+
+		if (live && direction != oldDirection)
+		{
+			reprap.GetPlatform().SetDirection(drive, direction);
+		}
+	}
+
+	// Work out how many steps to calculate at a time. A chunk of steps must not span a reversal.
+	uint32_t shiftFactor = 0;		// assume single stepping
+	if (stepInterval < DDA::MinCalcIntervalCartesian)
+	{
+		const uint32_t stepsToLimit = mp.arc.pieceFirstStep + mp.arc.pieceSteps - 1 - nextStep;
+#if DM_INTERPOLATE_STEPS
+		if (stepInterval < DDA::MinCalcIntervalCartesian/8 && stepsToLimit > 16)
+		{
+			shiftFactor = 4;		// hexadecimal stepping
+		}
+		else
+#endif
+		if (stepInterval < DDA::MinCalcIntervalCartesian/4 && stepsToLimit > 8)
+		{
+			shiftFactor = 3;		// octal stepping
+		}
+		else if (stepInterval < DDA::MinCalcIntervalCartesian/2 && stepsToLimit > 4)
+		{
+			shiftFactor = 2;		// quad stepping
+		}
+		else if (stepsToLimit > 2)
+		{
+			shiftFactor = 1;		// double stepping
+		}
+	}
+
+	stepsTillRecalc = (1u << shiftFactor) - 1u;					// store number of additional steps to generate
+	const int32_t stepsToCalc = (int32_t)stepsTillRecalc + 1;
+	mp.arc.currentLevel += (direction) ? stepsToCalc : -stepsToCalc;
+
+	// Find the phase at which the motor passes half way to the new position, and from that the distance moved along the path
+	const float targetPosition = (float)mp.arc.currentLevel + ((direction) ? -0.5 : 0.5);
+	const float acosValue = acosf(constrain<float>((targetPosition - mp.arc.centre)/mp.arc.radius, -1.0, 1.0));
+	const float phase = ((mp.arc.piece & 1) == 0) ? mp.arc.piece * PI + acosValue : (mp.arc.piece + 1) * PI - acosValue;
+	const float distance = fabsf(phase - mp.arc.phaseStart) * mp.arc.mmPerRadian;
+
+	// Convert the distance to the time since the start of the move
+	const uint32_t lastStepTime = nextStepTime;					// pick up the time of the last step
+	const float decelStartDistance = dda.totalDistance - dda.decelDistance;
+	float timeNeeded;
+#if DDA_PHASE_PROFILES
+	if ((distance < dda.accelDistance) ? dda.profiledAccel : (distance >= decelStartDistance && dda.profiledDecel))
+	{
+		const float twoCsquaredDivA = (float)(DDA::stepClockRateSquared * 2)/dda.acceleration;
+		const float clocks = (distance < dda.accelDistance)
+								? dda.AccelPhaseClocks(distance * twoCsquaredDivA, ExtrapolatedStepTime(lastStepTime))
+								: dda.DecelPhaseClocks(max<float>(dda.totalDistance - distance, 0.0) * twoCsquaredDivA, ExtrapolatedStepTime(lastStepTime));
+		timeNeeded = clocks/DDA::stepClockRate;
+	}
+	else
+#endif
+	if (distance < dda.accelDistance)
+	{
+		// acceleration phase
+		timeNeeded = (sqrtf(fsquare(dda.startSpeed) + 2 * dda.acceleration * distance) - dda.startSpeed)/dda.acceleration;
+	}
+	else
+	{
+#if SUPPORT_INPUT_SHAPING
+		// A shaped acceleration phase takes longer than it would at constant acceleration
+		const float accelStopTime = (dda.shapeAccel) ? (float)dda.accelClocks/DDA::stepClockRate : (dda.topSpeed - dda.startSpeed)/dda.acceleration;
+#else
+		const float accelStopTime = (dda.topSpeed - dda.startSpeed)/dda.acceleration;
+#endif
+		if (distance < decelStartDistance)
+		{
+			// steady speed phase
+			timeNeeded = accelStopTime + (distance - dda.accelDistance)/dda.topSpeed;
+		}
+		else
+		{
+			// deceleration phase, allowing for possible rounding error when the end speed is zero or very small
+			const float decelStartTime = accelStopTime + (decelStartDistance - dda.accelDistance)/dda.topSpeed;
+			timeNeeded = decelStartTime
+						+ (dda.topSpeed - sqrtf(max<float>(fsquare(dda.topSpeed) - 2 * dda.acceleration * (distance - decelStartDistance), 0.0)))/dda.acceleration;
+		}
+	}
+
+	nextStepTime = roundU32(timeNeeded * DDA::stepClockRate);
+	stepInterval = (nextStepTime - lastStepTime) >> shiftFactor;	// calculate the time per step, ready for next time
+
+	if (nextStepTime > dda.clocksNeeded)
+	{
+		// The calculation makes this step late. If it is the last one, bring it forward to the expected finish time.
+		if (nextStep + stepsTillRecalc + 1 >= totalSteps)
+		{
+			nextStepTime = dda.clocksNeeded;
+		}
+		else
+		{
+			// We don't expect any step except the last to be late
+			state = DMState::stepError;
+			stepInterval = 10000000 + nextStepTime;				// so we can tell what happened in the debug print
+			return false;
+		}
+	}
+
+#if DM_INTERPOLATE_STEPS
+	nextStepTime -= stepsTillRecalc * stepInterval;				// the time of the first step in this chunk, the inline function adds stepInterval for the others
+#endif
+	return true;
+}
+
+#endif
+
 void DriveMovement::DebugPrint(char c, bool isDeltaMovement) const
 {
 	if (state != DMState::idle)
@@ -267,6 +475,15 @@ void DriveMovement::DebugPrint(char c, bool isDeltaMovement) const
 						mp.delta.twoCsquaredTimesMmPerStepDivA, mp.delta.accelStopDsK, mp.delta.decelStartDsK, mp.delta.mmPerStepTimesCKdivtopSpeed
 						);
 		}
+#if SUPPORT_NATIVE_ARCS
+		else if (isArcAxis)
+		{
+			debugPrintf("radius=%f centre=%f phase=%f net=%" PRIi32 " mmPerRad=%f piece=%" PRIi32 " pfs=%" PRIu32 " ps=%" PRIu32 " level=%" PRIi32 "\n",
+						(double)mp.arc.radius, (double)mp.arc.centre, (double)mp.arc.phaseStart, mp.arc.netSteps,
+						(double)mp.arc.mmPerRadian, mp.arc.piece, mp.arc.pieceFirstStep, mp.arc.pieceSteps, mp.arc.currentLevel
+						);
+		}
+#endif
 		else
 		{
 			debugPrintf("accelStopStep=%" PRIu32 " decelStartStep=%" PRIu32 " 2CsqtMmPerStepDivA=%" PRIu64 "\n"
@@ -297,6 +514,14 @@ pre(nextStep < totalSteps; stepsTillRecalc == 0)
 									? reverseStartStep
 									: totalSteps
 								) - nextStep;
+#if DM_INTERPOLATE_STEPS
+		// Interpolated steps don't come in bursts, so we can afford larger chunks
+		if (stepInterval < DDA::MinCalcIntervalCartesian/8 && stepsToLimit > 16)
+		{
+			shiftFactor = 4;		// hexadecimal stepping
+		}
+		else
+#endif
 		if (stepInterval < DDA::MinCalcIntervalCartesian/4 && stepsToLimit > 8)
 		{
 			shiftFactor = 3;		// octal stepping
@@ -318,8 +543,17 @@ pre(nextStep < totalSteps; stepsTillRecalc == 0)
 	if (nextCalcStep < mp.cart.accelStopStep)
 	{
 		// acceleration phase
-		const uint32_t adjustedStartSpeedTimesCdivA = dda.startSpeedTimesCdivA + mp.cart.compensationClocks;
-		nextStepTime = isqrt64(isquare64(adjustedStartSpeedTimesCdivA) + (mp.cart.twoCsquaredTimesMmPerStepDivA * nextCalcStep)) - adjustedStartSpeedTimesCdivA;
+#if DDA_PHASE_PROFILES
+		if (dda.profiledAccel)
+		{
+			nextStepTime = roundU32(dda.AccelPhaseClocks((float)(mp.cart.twoCsquaredTimesMmPerStepDivA * nextCalcStep), ExtrapolatedStepTime(lastStepTime)));
+		}
+		else
+#endif
+		{
+			const uint32_t adjustedStartSpeedTimesCdivA = dda.startSpeedTimesCdivA + mp.cart.compensationClocks;
+			nextStepTime = isqrt64(isquare64(adjustedStartSpeedTimesCdivA) + (mp.cart.twoCsquaredTimesMmPerStepDivA * nextCalcStep)) - adjustedStartSpeedTimesCdivA;
+		}
 	}
 	else if (nextCalcStep < mp.cart.decelStartStep)
 	{
@@ -333,11 +567,21 @@ pre(nextStep < totalSteps; stepsTillRecalc == 0)
 	{
 		// deceleration phase, not reversed yet
 		const uint64_t temp = mp.cart.twoCsquaredTimesMmPerStepDivA * nextCalcStep;
-		const uint32_t adjustedTopSpeedTimesCdivAPlusDecelStartClocks = dda.topSpeedTimesCdivAPlusDecelStartClocks - mp.cart.compensationClocks;
-		// Allow for possible rounding error when the end speed is zero or very small
-		nextStepTime = (temp < twoDistanceToStopTimesCsquaredDivA)
-						? adjustedTopSpeedTimesCdivAPlusDecelStartClocks - isqrt64(twoDistanceToStopTimesCsquaredDivA - temp)
-						: adjustedTopSpeedTimesCdivAPlusDecelStartClocks;
+#if DDA_PHASE_PROFILES
+		if (dda.profiledDecel)
+		{
+			const float remainingX = (temp < dda.twoCsquaredTimesTotalDistanceDivA) ? (float)(dda.twoCsquaredTimesTotalDistanceDivA - temp) : 0.0;
+			nextStepTime = roundU32(dda.DecelPhaseClocks(remainingX, ExtrapolatedStepTime(lastStepTime)));
+		}
+		else
+#endif
+		{
+			const uint32_t adjustedTopSpeedTimesCdivAPlusDecelStartClocks = dda.topSpeedTimesCdivAPlusDecelStartClocks - mp.cart.compensationClocks;
+			// Allow for possible rounding error when the end speed is zero or very small
+			nextStepTime = (temp < twoDistanceToStopTimesCsquaredDivA)
+							? adjustedTopSpeedTimesCdivAPlusDecelStartClocks - isqrt64(twoDistanceToStopTimesCsquaredDivA - temp)
+							: adjustedTopSpeedTimesCdivAPlusDecelStartClocks;
+		}
 	}
 	else
 	{
@@ -375,6 +619,10 @@ pre(nextStep < totalSteps; stepsTillRecalc == 0)
 			return false;
 		}
 	}
+
+#if DM_INTERPOLATE_STEPS
+	nextStepTime -= stepsTillRecalc * stepInterval;				// the time of the first step in this chunk, the inline function adds stepInterval for the others
+#endif
 	return true;
 }
 
@@ -451,7 +699,16 @@ pre(nextStep < totalSteps; stepsTillRecalc == 0)
 	if ((uint32_t)dsK < mp.delta.accelStopDsK)
 	{
 		// Acceleration phase
-		nextStepTime = isqrt64(isquare64(dda.startSpeedTimesCdivA) + (mp.delta.twoCsquaredTimesMmPerStepDivA * (uint32_t)dsK)/K2) - dda.startSpeedTimesCdivA;
+#if DDA_PHASE_PROFILES
+		if (dda.profiledAccel)
+		{
+			nextStepTime = roundU32(dda.AccelPhaseClocks((float)((mp.delta.twoCsquaredTimesMmPerStepDivA * (uint32_t)dsK)/K2), ExtrapolatedStepTime(lastStepTime)));
+		}
+		else
+#endif
+		{
+			nextStepTime = isqrt64(isquare64(dda.startSpeedTimesCdivA) + (mp.delta.twoCsquaredTimesMmPerStepDivA * (uint32_t)dsK)/K2) - dda.startSpeedTimesCdivA;
+		}
 	}
 	else if ((uint32_t)dsK < mp.delta.decelStartDsK)
 	{
@@ -463,10 +720,20 @@ pre(nextStep < totalSteps; stepsTillRecalc == 0)
 	else
 	{
 		const uint64_t temp = (mp.delta.twoCsquaredTimesMmPerStepDivA * (uint32_t)dsK)/K2;
-		// Because of possible rounding error when the end speed is zero or very small, we need to check that the square root will work OK
-		nextStepTime = (temp < twoDistanceToStopTimesCsquaredDivA)
-						? dda.topSpeedTimesCdivAPlusDecelStartClocks - isqrt64(twoDistanceToStopTimesCsquaredDivA - temp)
-						: dda.topSpeedTimesCdivAPlusDecelStartClocks;
+#if DDA_PHASE_PROFILES
+		if (dda.profiledDecel)
+		{
+			const float remainingX = (temp < dda.twoCsquaredTimesTotalDistanceDivA) ? (float)(dda.twoCsquaredTimesTotalDistanceDivA - temp) : 0.0;
+			nextStepTime = roundU32(dda.DecelPhaseClocks(remainingX, ExtrapolatedStepTime(lastStepTime)));
+		}
+		else
+#endif
+		{
+			// Because of possible rounding error when the end speed is zero or very small, we need to check that the square root will work OK
+			nextStepTime = (temp < twoDistanceToStopTimesCsquaredDivA)
+							? dda.topSpeedTimesCdivAPlusDecelStartClocks - isqrt64(twoDistanceToStopTimesCsquaredDivA - temp)
+							: dda.topSpeedTimesCdivAPlusDecelStartClocks;
+		}
 	}
 
 	stepInterval = (nextStepTime - lastStepTime) >> shiftFactor;	// calculate the time per step, ready for next time
@@ -489,6 +756,10 @@ pre(nextStep < totalSteps; stepsTillRecalc == 0)
 			return false;
 		}
 	}
+
+#if DM_INTERPOLATE_STEPS
+	nextStepTime -= stepsTillRecalc * stepInterval;		// the time of the first step in this chunk, the inline function adds stepInterval for the others
+#endif
 	return true;
 }
 
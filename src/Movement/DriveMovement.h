@@ -14,6 +14,11 @@ class LinearDeltaKinematics;
 
 #define ROUND_TO_NEAREST	(0)			// 1 for round to nearest (as used in 1.20beta10), 0 for round down (as used prior to 1.20beta10)
 
+// When the step interval is too short to calculate every step, we calculate the time of the last step in a chunk of 2, 4, 8 or 16 steps.
+// If DM_INTERPOLATE_STEPS is 1, the steps within the chunk are spaced evenly between the previous step and the last one, so the ISR only
+// has to add the step interval for each intermediate step. If it is 0, all the steps in the chunk are generated together at the end of it.
+#define DM_INTERPOLATE_STEPS	(1)
+
 // Rounding functions, to improve code clarity. Also allows a quick switch between round-to-nearest and round down in the movement code.
 inline uint32_t roundU32(float f)
 {
@@ -126,6 +131,10 @@ public:
 	void PrepareCartesianAxis(const DDA& dda, const PrepParams& params) __attribute__ ((hot));
 	void PrepareDeltaAxis(const DDA& dda, const PrepParams& params) __attribute__ ((hot));
 	void PrepareExtruder(const DDA& dda, const PrepParams& params, bool doCompensation) __attribute__ ((hot));
+#if SUPPORT_NATIVE_ARCS
+	int32_t InitArcAxis(const DDA& dda, float stepsPerMm, float phaseOffset);
+	void PrepareArcAxis(const DDA& dda) __attribute__ ((hot));
+#endif
 	void ReduceSpeed(const DDA& dda, uint32_t inverseSpeedFactor);
 	void DebugPrint(char c, bool withDelta) const;
 	int32_t GetNetStepsLeft() const;
@@ -137,6 +146,7 @@ public:
 
 	static void InitialAllocate(unsigned int num);
 	static int NumFree() { return numFree; }
+	static int NumTotal() { return numTotal; }
 	static int MinFree() { return minFree; }
 	static void ResetMinFree() { minFree = numFree; }
 	static DriveMovement *Allocate(size_t drive, DMState st);
@@ -145,10 +155,19 @@ public:
 private:
 	bool CalcNextStepTimeCartesianFull(const DDA &dda, bool live) __attribute__ ((hot));
 	bool CalcNextStepTimeDeltaFull(const DDA &dda, bool live) __attribute__ ((hot));
+#if SUPPORT_NATIVE_ARCS
+	bool CalcNextStepTimeArcFull(const DDA &dda, bool live) __attribute__ ((hot));
+	int32_t FirstArcPiece(const DDA& dda) const;
+	bool SetArcPiece(const DDA& dda, int32_t piece);
+#endif
+#if DDA_PHASE_PROFILES
+	float ExtrapolatedStepTime(uint32_t lastStepTime) const;
+#endif
 
 	static DriveMovement *freeList;
 	static int numFree;
 	static int minFree;
+	static int numTotal;
 
 	// Parameters common to Cartesian, delta and extruder moves
 
@@ -158,7 +177,8 @@ private:
 	uint8_t drive;										// the drive that this DM controls
 	uint8_t microstepShift : 4,							// log2 of the microstepping factor (for when we use dynamic microstepping adjustment)
 			direction : 1,								// true=forwards, false=backwards
-			fullCurrent : 1;							// true if the drivers are set to the full current, false if they are set to the standstill current
+			fullCurrent : 1,							// true if the drivers are set to the full current, false if they are set to the standstill current
+			isArcAxis : 1;								// true if this is the X or Y axis of an arc move
 	uint8_t stepsTillRecalc;							// how soon we need to recalculate
 
 	uint32_t totalSteps;								// total number of steps for this move
@@ -167,7 +187,7 @@ private:
 	uint32_t nextStep;									// number of steps already done
 	uint32_t reverseStartStep;							// the step number for which we need to reverse direction due to pressure advance or delta movement
 	uint32_t nextStepTime;								// how many clocks after the start of this move the next step is due
-	uint32_t stepInterval;								// how many clocks between steps
+	uint32_t stepInterval;								// how many clocks between steps (when interpolating, the interval between steps in the current chunk)
 
 	// The following only needs to be stored per-drive if we are supporting pressure advance
 	uint64_t twoDistanceToStopTimesCsquaredDivA;
@@ -202,6 +222,24 @@ private:
 			uint32_t decelStartDsK;
 			uint32_t mmPerStepTimesCKdivtopSpeed;
 		} delta;
+
+#if SUPPORT_NATIVE_ARCS
+		struct ArcParameters							// Parameters for the X or Y axis of an arc move. Positions are in steps relative to the start position.
+		{
+			// The following don't depend on how the move is executed, so they are set up in Init()
+			float radius;								// the radius of the arc in steps
+			float centre;								// the position of the centre of the arc
+			float phaseStart;							// the angle of the start point from the centre, less PI/2 for the Y axis
+			int32_t netSteps;							// the net movement of this axis
+
+			// The following depend on how the move is executed, so they must be set up in Prepare()
+			float mmPerRadian;							// the distance moved along the path per radian of the arc
+			int32_t piece;								// the current piece of the arc, which spans the phase angles piece*PI to (piece+1)*PI
+			uint32_t pieceFirstStep;					// the number of the first step in the current piece
+			uint32_t pieceSteps;						// the number of steps in the current piece
+			int32_t currentLevel;						// the position after the last step whose time we have calculated
+		} arc;
+#endif
 	} mp;
 
 	static constexpr uint32_t NoStepTime = 0xFFFFFFFF;	// value to indicate that no further steps are needed when calculating the next step time
@@ -210,9 +248,20 @@ private:
 	static constexpr int32_t Kc = 1024 * 1024;			// a power of 2 for scaling the Z movement fraction
 };
 
+#if DDA_PHASE_PROFILES
+
+// Estimate the time of the last step in the chunk being calculated by extrapolating from the previous step interval, or return -1 if this is the first step.
+// This is used as the starting point when solving for the step time in profiled acceleration and deceleration phases.
+inline float DriveMovement::ExtrapolatedStepTime(uint32_t lastStepTime) const
+{
+	return (nextStep > 1) ? (float)lastStepTime + (float)stepInterval * (float)(stepsTillRecalc + 1) : -1.0;
+}
+
+#endif
+
 // Calculate and store the time since the start of the move when the next step for the specified DriveMovement is due.
 // Return true if there are more steps to do. When finished, leave nextStep == totalSteps + 1.
-// This is also used for extruders on delta machines.
+// This is also used for extruders on delta machines, and for the X and Y axes of arc moves.
 // We inline this part to speed things up when we are doing double/quad/octal stepping.
 inline bool DriveMovement::CalcNextStepTimeCartesian(const DDA &dda, bool live)
 {
@@ -222,8 +271,17 @@ inline bool DriveMovement::CalcNextStepTimeCartesian(const DDA &dda, bool live)
 		if (stepsTillRecalc != 0)
 		{
 			--stepsTillRecalc;			// we are doing double/quad/octal stepping
+#if DM_INTERPOLATE_STEPS
+			nextStepTime += stepInterval;
+#endif
 			return true;
 		}
+#if SUPPORT_NATIVE_ARCS
+		if (isArcAxis)
+		{
+			return CalcNextStepTimeArcFull(dda, live);
+		}
+#endif
 		return CalcNextStepTimeCartesianFull(dda, live);
 	}
 
@@ -242,6 +300,9 @@ inline bool DriveMovement::CalcNextStepTimeDelta(const DDA &dda, bool live)
 		if (stepsTillRecalc != 0)
 		{
 			--stepsTillRecalc;			// we are doing double or quad stepping
+#if DM_INTERPOLATE_STEPS
+			nextStepTime += stepInterval;
+#endif
 			return true;
 		}
 		else
@@ -258,6 +319,13 @@ inline bool DriveMovement::CalcNextStepTimeDelta(const DDA &dda, bool live)
 // We have already taken nextSteps - 1 steps, unless nextStep is zero.
 inline int32_t DriveMovement::GetNetStepsLeft() const
 {
+#if SUPPORT_NATIVE_ARCS
+	if (isArcAxis)
+	{
+		return mp.arc.netSteps - GetNetStepsTaken();
+	}
+#endif
+
 	int32_t netStepsLeft;
 	if (reverseStartStep > totalSteps)		// if no reverse phase
 	{
@@ -279,6 +347,17 @@ inline int32_t DriveMovement::GetNetStepsLeft() const
 // We have already taken nextSteps - 1 steps, unless nextStep is zero.
 inline int32_t DriveMovement::GetNetStepsTaken() const
 {
+#if SUPPORT_NATIVE_ARCS
+	if (isArcAxis)
+	{
+		// currentLevel is the position after the last step in the chunk whose time we have calculated, and the steps in that chunk are all in the current direction
+		const int32_t stepsNotTaken = (int32_t)stepsTillRecalc + 1;
+		return (nextStep == 0) ? 0
+				: (nextStep > totalSteps) ? mp.arc.netSteps
+					: (direction) ? mp.arc.currentLevel - stepsNotTaken : mp.arc.currentLevel + stepsNotTaken;
+	}
+#endif
+
 	int32_t netStepsTaken;
 	if (nextStep < reverseStartStep || reverseStartStep > totalSteps)				// if no reverse phase, or not started it yet
 	{
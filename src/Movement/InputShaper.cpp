@@ -0,0 +1,365 @@
+/*
+ * InputShaper.cpp
+ *
+ *  Created on: 16 Oct 2026
+ *      Author: agent
+ */
+
+#include "InputShaper.h"
+
+#if SUPPORT_INPUT_SHAPING
+
+#include "DDA.h"
+#include "GCodes/GCodeBuffer.h"
+#include "Platform.h"
+#include "RepRap.h"
+
+InputShaper::InputShaper()
+	: type(InputShaperType::none), frequency(DefaultInputShaperFrequency), damping(DefaultInputShaperDamping), numImpulses(0), duration(0.0), centroidOffset(0.0),
+	  numShapedMoves(0), numUnshapedMoves(0)
+{
+}
+
+// Process M594, which configures input shaping. The caller has already waited for movement to stop.
+// P"none"/"zv"/"zvd"/"ei" selects the type of shaping, F sets the ringing frequency in Hz, S sets the damping ratio.
+// If the frequency or damping is given without a type while shaping is disabled, we enable ZVD shaping.
+GCodeResult InputShaper::Configure(GCodeBuffer& gb, StringRef& reply)
+{
+	bool seen = false;
+	InputShaperType newType = type;
+	String<8> typeName;
+	if (gb.Seen('P'))
+	{
+		seen = true;
+		if (!gb.GetPossiblyQuotedString(typeName.GetRef()))
+		{
+			reply.copy("Missing input shaper type");
+			return GCodeResult::error;
+		}
+		if (StringEquals(typeName.c_str(), "none"))
+		{
+			newType = InputShaperType::none;
+		}
+		else if (StringEquals(typeName.c_str(), "zv"))
+		{
+			newType = InputShaperType::zv;
+		}
+		else if (StringEquals(typeName.c_str(), "zvd"))
+		{
+			newType = InputShaperType::zvd;
+		}
+		else if (StringEquals(typeName.c_str(), "ei"))
+		{
+			newType = InputShaperType::ei;
+		}
+		else
+		{
+			reply.printf("Unknown input shaper type '%s'", typeName.c_str());
+			return GCodeResult::error;
+		}
+	}
+
+	float newFrequency = frequency, newDamping = damping;
+	bool seenParam = false;
+	gb.TryGetFValue('F', newFrequency, seenParam);
+	gb.TryGetFValue('S', newDamping, seenParam);
+	if (seenParam)
+	{
+		if (newFrequency < MinInputShaperFrequency)
+		{
+			reply.printf("Input shaper frequency must be at least %.1fHz", (double)MinInputShaperFrequency);
+			return GCodeResult::error;
+		}
+		if (newDamping < 0.0 || newDamping >= 1.0)
+		{
+			reply.copy("Input shaper damping ratio must be at least 0 and less than 1");
+			return GCodeResult::error;
+		}
+		if (!seen && newType == InputShaperType::none)
+		{
+			newType = InputShaperType::zvd;
+		}
+		seen = true;
+	}
+
+	if (seen)
+	{
+		type = newType;
+		frequency = newFrequency;
+		damping = newDamping;
+		CalculateImpulses();
+
+		// Check that shaped phases from much shorter to much longer than the impulse sequence behave as the movement code expects
+		static const float CheckedSpeedChanges[] = { 0.01, 0.25, 1.0, 4.0, 16.0 };		// multiples of the duration of the impulse sequence
+		for (float f : CheckedSpeedChanges)
+		{
+			if (IsActive() && !CheckPhase(f * duration, reply))
+			{
+				type = InputShaperType::none;
+				CalculateImpulses();
+				return GCodeResult::error;
+			}
+		}
+	}
+	else if (type == InputShaperType::none)
+	{
+		reply.copy("Input shaping is disabled");
+	}
+	else
+	{
+		static const char * const TypeNames[] = { "none", "ZV", "ZVD", "EI" };
+		reply.printf("Input shaping %s at %.1fHz, damping ratio %.2f, impulses", TypeNames[(size_t)type], (double)frequency, (double)damping);
+		for (size_t i = 0; i < numImpulses; ++i)
+		{
+			reply.catf(" %.3f@%.2fms", (double)amplitudes[i], (double)(delays[i] * 1000.0/DDA::stepClockRate));
+		}
+	}
+	return GCodeResult::ok;
+}
+
+// Calculate the impulse amplitudes and times from the type, frequency and damping ratio
+void InputShaper::CalculateImpulses()
+{
+	const float dampingFactor = sqrtf(1.0 - fsquare(damping));
+	const float k = expf(-damping * PI/dampingFactor);
+	const float halfPeriodClocks = (0.5 * DDA::stepClockRate)/(frequency * dampingFactor);		// half the damped ringing period
+
+	switch (type)
+	{
+	case InputShaperType::zv:
+		numImpulses = 2;
+		amplitudes[0] = 1.0;
+		amplitudes[1] = k;
+		break;
+
+	case InputShaperType::zvd:
+		numImpulses = 3;
+		amplitudes[0] = 1.0;
+		amplitudes[1] = 2.0 * k;
+		amplitudes[2] = fsquare(k);
+		break;
+
+	case InputShaperType::ei:
+		{
+			constexpr float VibrationTolerance = 0.05;
+			numImpulses = 3;
+			amplitudes[0] = 0.25 * (1.0 + VibrationTolerance);
+			amplitudes[1] = 0.5 * (1.0 - VibrationTolerance) * k;
+			amplitudes[2] = amplitudes[0] * fsquare(k);
+		}
+		break;
+
+	case InputShaperType::none:
+	default:
+		numImpulses = 0;
+		duration = centroidOffset = 0.0;
+		return;
+	}
+
+	// Normalise the amplitudes and find the centroid. The impulses are always half a period apart.
+	float sum = 0.0;
+	for (size_t i = 0; i < numImpulses; ++i)
+	{
+		sum += amplitudes[i];
+	}
+	float centroid = 0.0;
+	for (size_t i = 0; i < numImpulses; ++i)
+	{
+		amplitudes[i] /= sum;
+		delays[i] = i * halfPeriodClocks;
+		centroid += amplitudes[i] * delays[i];
+	}
+	duration = delays[numImpulses - 1];
+	centroidOffset = 0.5 * duration - centroid;
+}
+
+// Return the shortest time in step clocks in which a phase with the given speed change can be shaped without the acceleration exceeding the nominal
+// acceleration. 'speedChange' is in the units used by SolvePhase, so it is also the time that the phase would take at the nominal acceleration.
+// The highest acceleration is g2, which is speedChange/p * (1 + 4 * centroidOffset/p) for a pulse of length p; and g1 must not be negative, so p >= 4 * centroidOffset.
+float InputShaper::GetPhaseClocks(float speedChange) const
+{
+	const float pulseClocks = 0.5 * (speedChange + sqrtf(fsquare(speedChange) + 16.0 * centroidOffset * speedChange));
+	return max<float>(pulseClocks, max<float>(4.0 * centroidOffset, 1.0)) + duration;
+}
+
+// Return the time in step clocks since the start of a shaped acceleration or deceleration phase at which it has covered distance 'x'.
+// The units are the same as for DDA::SolveSCurvePhase, so the nominal acceleration is 1 and 'initialSpeed' and 'speedChange' are speeds multiplied by
+// stepClockRate/acceleration. 'phaseClocks' must be at least GetPhaseClocks(speedChange). 'estimate' is an estimate of the result, or negative if we don't have one.
+float InputShaper::SolvePhase(float x, float initialSpeed, float speedChange, float phaseClocks, bool decelerating, float estimate) const
+{
+	constexpr unsigned int MaxIterations = 16;
+
+	if (x <= 0.0)
+	{
+		return 0.0;
+	}
+
+	Pulse pulse;
+	MakePulse(speedChange, phaseClocks, pulse);
+	const float sign = (decelerating) ? -1.0 : 1.0;
+
+	float low = 0.0, high = phaseClocks;
+	float t = (estimate < 0.0) ? 0.5 * phaseClocks : min<float>(estimate, phaseClocks);
+	for (unsigned int i = 0; i < MaxIterations; ++i)
+	{
+		float shapedDistance, shapedSpeed;
+		GetPhaseState(pulse, t, shapedDistance, shapedSpeed);
+		const float error = 2.0 * (initialSpeed * t + sign * shapedDistance) - x;
+		if (error > 0.0)
+		{
+			high = t;
+		}
+		else
+		{
+			low = t;
+		}
+		const float speed = 2.0 * (initialSpeed + sign * shapedSpeed);
+		float newT = (speed > 0.0) ? t - error/speed : -1.0;
+		if (newT < low || newT > high)
+		{
+			newT = 0.5 * (low + high);
+		}
+		if (fabsf(newT - t) < 1.0)
+		{
+			return newT;
+		}
+		t = newT;
+	}
+	return t;
+}
+
+// Count a move that we shaped, or that was too short to shape without exceeding the acceleration
+void InputShaper::RecordMove(bool shaped)
+{
+	if (shaped)
+	{
+		++numShapedMoves;
+	}
+	else
+	{
+		++numUnshapedMoves;
+	}
+}
+
+void InputShaper::Diagnostics(MessageType mtype)
+{
+	if (IsActive())
+	{
+		reprap.GetPlatform().MessageF(mtype, "Input shaping: moves shaped %" PRIu32 ", too short to shape %" PRIu32 "\n", numShapedMoves, numUnshapedMoves);
+	}
+	numShapedMoves = numUnshapedMoves = 0;
+}
+
+// Set up the acceleration pulse for a phase. The pulse lasts for phaseClocks - duration, with acceleration g1 in its first half and g2 in its second half.
+void InputShaper::MakePulse(float speedChange, float phaseClocks, Pulse& pulse) const
+{
+	pulse.clocks = phaseClocks - duration;
+	pulse.halfClocks = 0.5 * pulse.clocks;
+	const float meanAccel = speedChange/pulse.clocks;
+	const float accelAdjustment = meanAccel * 4.0 * centroidOffset/pulse.clocks;
+	pulse.g1 = meanAccel - accelAdjustment;
+	pulse.g2 = meanAccel + accelAdjustment;
+	pulse.halfSpeed = pulse.g1 * pulse.halfClocks;
+	pulse.halfDistance = 0.5 * pulse.halfSpeed * pulse.halfClocks;
+	pulse.distance = pulse.halfDistance + pulse.halfClocks * (pulse.halfSpeed + 0.5 * pulse.g2 * pulse.halfClocks);
+	pulse.speedChange = speedChange;
+}
+
+// Get the distance moved and the speed change at time 't' into a shaped phase, by adding up the effect of each impulse convolved with the pulse
+void InputShaper::GetPhaseState(const Pulse& pulse, float t, float& distance, float& speed) const
+{
+	distance = speed = 0.0;
+	for (size_t j = 0; j < numImpulses; ++j)
+	{
+		const float tp = t - delays[j];
+		if (tp <= 0.0)
+		{
+			break;
+		}
+		if (tp <= pulse.halfClocks)
+		{
+			distance += amplitudes[j] * 0.5 * pulse.g1 * fsquare(tp);
+			speed += amplitudes[j] * pulse.g1 * tp;
+		}
+		else if (tp <= pulse.clocks)
+		{
+			const float tp2 = tp - pulse.halfClocks;
+			distance += amplitudes[j] * (pulse.halfDistance + tp2 * (pulse.halfSpeed + 0.5 * pulse.g2 * tp2));
+			speed += amplitudes[j] * (pulse.halfSpeed + pulse.g2 * tp2);
+		}
+		else
+		{
+			distance += amplitudes[j] * (pulse.distance + pulse.speedChange * (tp - pulse.clocks));
+			speed += amplitudes[j] * pulse.speedChange;
+		}
+	}
+}
+
+// Get the acceleration just after time 't' into a shaped phase
+float InputShaper::GetPhaseAcceleration(const Pulse& pulse, float t) const
+{
+	float accel = 0.0;
+	for (size_t j = 0; j < numImpulses; ++j)
+	{
+		const float tp = t - delays[j];
+		if (tp >= 0.0 && tp < pulse.halfClocks)
+		{
+			accel += amplitudes[j] * pulse.g1;
+		}
+		else if (tp >= pulse.halfClocks && tp < pulse.clocks)
+		{
+			accel += amplitudes[j] * pulse.g2;
+		}
+	}
+	return accel;
+}
+
+// Check a shaped phase against an unshaped one with the same speed change and duration. It must end at the same speed, cover the same distance,
+// and give the same step times; and its acceleration must never exceed the nominal acceleration or be negative.
+// Return true if it passes, else put an error message in 'reply'.
+bool InputShaper::CheckPhase(float speedChange, StringRef& reply) const
+{
+	constexpr float Tolerance = 0.001;
+
+	const float phaseClocks = GetPhaseClocks(speedChange);
+	Pulse pulse;
+	MakePulse(speedChange, phaseClocks, pulse);
+
+	float distance, speed;
+	GetPhaseState(pulse, phaseClocks, distance, speed);
+	const float unshapedDistance = 0.5 * speedChange * phaseClocks;			// the distance at a constant acceleration of speedChange/phaseClocks
+	bool ok = fabsf(speed - speedChange) <= Tolerance * speedChange && fabsf(distance - unshapedDistance) <= Tolerance * unshapedDistance;
+
+	// Check that we get back the time at which we reach the distance moved half way through the phase
+	if (ok)
+	{
+		const float halfTime = 0.5 * phaseClocks;
+		GetPhaseState(pulse, halfTime, distance, speed);
+		ok = fabsf(SolvePhase(2.0 * distance, 0.0, speedChange, phaseClocks, false, -1.0) - halfTime) <= 2.0;
+	}
+
+	// The acceleration only changes when an impulse starts, reaches the second half of the pulse or reaches the end of it, so we only need to check those times
+	for (size_t i = 0; ok && i < numImpulses; ++i)
+	{
+		const float times[3] = { delays[i], delays[i] + pulse.halfClocks, delays[i] + pulse.clocks };
+		for (float t : times)
+		{
+			const float accel = GetPhaseAcceleration(pulse, t);
+			if (accel > 1.0 + Tolerance || accel < -Tolerance)
+			{
+				ok = false;
+				break;
+			}
+		}
+	}
+
+	if (!ok)
+	{
+		reply.printf("Input shaping disabled because a %.1fms phase failed its check", (double)(phaseClocks * 1000.0/DDA::stepClockRate));
+	}
+	return ok;
+}
+
+#endif
+
+// End
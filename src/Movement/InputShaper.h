@@ -0,0 +1,83 @@
+/*
+ * InputShaper.h
+ *
+ *  Created on: 16 Oct 2026
+ *      Author: agent
+ */
+
+#ifndef SRC_MOVEMENT_INPUTSHAPER_H_
+#define SRC_MOVEMENT_INPUTSHAPER_H_
+
+#include "RepRapFirmware.h"
+
+#if SUPPORT_INPUT_SHAPING
+
+#include "GCodes/GCodeResult.h"
+#include "MessageType.h"
+
+class GCodeBuffer;
+
+enum class InputShaperType : uint8_t
+{
+	none = 0,
+	zv,					// zero vibration, 2 impulses
+	zvd,				// zero vibration and derivative, 3 impulses, less sensitive to frequency error than ZV
+	ei					// extra insensitive, 3 impulses, allows 5% vibration at the nominal frequency to be much less sensitive to frequency error
+};
+
+// Class to shape the acceleration and deceleration phases of moves so as not to excite ringing at a resonant frequency of the machine.
+// The acceleration in each phase is a pulse convolved with a sequence of impulses, so the phase still starts and ends at the planned speeds.
+// The shaped acceleration is spread over a longer time than constant acceleration would take, so DDA::Prepare lengthens each shaped phase enough
+// to keep the peak acceleration within the planned acceleration, lowering the top speed if necessary. A move that is too short for that is not
+// shaped, and we count those moves so that M122 can report them.
+// The impulse amplitudes allow for damping, which makes the sequence asymmetric; so we make the pulse itself heavier in its second half by the
+// amount needed for the phase to cover the same distance as it would at constant acceleration over the same time.
+// Because each shaped phase begins and ends with zero acceleration, the boundaries between shaped phases, including those between moves, are shaped too.
+class InputShaper
+{
+public:
+	InputShaper();
+
+	GCodeResult Configure(GCodeBuffer& gb, StringRef& reply);				// process M594
+	bool IsActive() const { return numImpulses != 0; }
+	float GetPhaseClocks(float speedChange) const;							// return the shortest time in which we can shape a phase without exceeding the acceleration
+	float SolvePhase(float x, float initialSpeed, float speedChange, float phaseClocks, bool decelerating, float estimate) const __attribute__ ((hot));
+	void RecordMove(bool shaped);											// count a move that we shaped or left unshaped
+	void Diagnostics(MessageType mtype);
+
+	static constexpr size_t MaxImpulses = 3;
+
+private:
+	// The acceleration pulse that we convolve with the impulses. The units are those used by SolvePhase.
+	struct Pulse
+	{
+		float clocks;														// the length of the pulse
+		float halfClocks;
+		float g1, g2;														// the acceleration in the first and second halves of the pulse
+		float halfSpeed;													// the speed change during the first half of the pulse
+		float halfDistance;													// the distance moved during the first half of the pulse
+		float distance;														// the distance moved during the whole pulse
+		float speedChange;													// the speed change during the whole pulse
+	};
+
+	void CalculateImpulses();
+	void MakePulse(float speedChange, float phaseClocks, Pulse& pulse) const;
+	void GetPhaseState(const Pulse& pulse, float t, float& distance, float& speed) const;
+	float GetPhaseAcceleration(const Pulse& pulse, float t) const;
+	bool CheckPhase(float speedChange, StringRef& reply) const;
+
+	InputShaperType type;
+	float frequency;														// the ringing frequency in Hz
+	float damping;															// the damping ratio of the ringing
+	size_t numImpulses;														// zero if input shaping is disabled
+	float amplitudes[MaxImpulses];											// the impulse amplitudes, which add up to 1
+	float delays[MaxImpulses];												// the impulse times in step clocks, in increasing order
+	float duration;															// the time of the last impulse in step clocks
+	float centroidOffset;													// how much the centroid of the impulses is earlier than half the duration, in step clocks
+	uint32_t numShapedMoves;												// how many moves we have shaped since the last diagnostics report
+	uint32_t numUnshapedMoves;												// how many moves were too short to shape since the last diagnostics report
+};
+
+#endif
+
+#endif /* SRC_MOVEMENT_INPUTSHAPER_H_ */
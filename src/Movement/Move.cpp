@@ -10,6 +10,7 @@
 
 static constexpr uint32_t UsualMinimumPreparedTime = DDA::stepClockRate/10;			// 100ms
 static constexpr uint32_t AbsoluteMinimumPreparedTime = DDA::stepClockRate/20;		// 50ms
+static constexpr unsigned int MaxSimulatedMovesPerSpin = 32;						// limit on the moves we simulate in one call to Spin, so that other modules get a look in
 
 Move::Move() : currentDda(nullptr), active(false), scheduledMoves(0), completedMoves(0)
 {
@@ -18,6 +19,7 @@ Move::Move() : currentDda(nullptr), active(false), scheduledMoves(0), completedM
 	// Build the DDA ring
 	DDA *dda = new DDA(nullptr);
 	ddaRingGetPointer = ddaRingAddPointer = dda;
+	ddaRingLength = DdaRingLength;
 	for (size_t i = 1; i < DdaRingLength; i++)
 	{
 		DDA * const oldDda = dda;
@@ -118,6 +120,12 @@ void Move::Spin()
 		++idleCount;
 	}
 
+	if (simulationMode != 0)
+	{
+		SpinSimulation();
+		return;
+	}
+
 	// Recycle the DDAs for completed moves, checking for DDA errors to print if Move debug is enabled
 	while (ddaRingCheckPointer->GetState() == DDA::completed)
 	{
@@ -175,23 +183,20 @@ void Move::Spin()
 		// OK to add another move. First check if a special move is available.
 		if (specialMoveAvailable)
 		{
-			if (simulationMode < 2)
+			if (ddaRingAddPointer->Init(specialMoveCoords))
 			{
-				if (ddaRingAddPointer->Init(specialMoveCoords))
+				ddaRingAddPointer = ddaRingAddPointer->GetNext();
+				if (moveState == MoveState::idle || moveState == MoveState::timing)
 				{
-					ddaRingAddPointer = ddaRingAddPointer->GetNext();
-					if (moveState == MoveState::idle || moveState == MoveState::timing)
+					// We were previously idle, so we have a state change
+					moveState = MoveState::collecting;
+					const uint32_t now = millis();
+					const uint32_t timeWaiting = now - lastStateChangeTime;
+					if (timeWaiting > longestGcodeWaitInterval)
 					{
-						// We were previously idle, so we have a state change
-						moveState = MoveState::collecting;
-						const uint32_t now = millis();
-						const uint32_t timeWaiting = now - lastStateChangeTime;
-						if (timeWaiting > longestGcodeWaitInterval)
-						{
-							longestGcodeWaitInterval = timeWaiting;
-						}
-						lastStateChangeTime = now;
+						longestGcodeWaitInterval = timeWaiting;
 					}
+					lastStateChangeTime = now;
 				}
 			}
 			specialMoveAvailable = false;
@@ -202,45 +207,42 @@ void Move::Spin()
 			GCodes::RawMove nextMove;
 			if (reprap.GetGCodes().ReadMove(nextMove))		// if we have a new move
 			{
-				if (simulationMode < 2)		// in simulation mode 2 and higher, we don't process incoming moves beyond this point
-				{
 #if 0	// disabled this because it causes jerky movements on the SCARA printer
-					// Add on the extrusion left over from last time.
-					const size_t numAxes = reprap.GetGCodes().GetTotalAxes();
-					for (size_t drive = numAxes; drive < DRIVES; ++drive)
-					{
-						nextMove.coords[drive] += extrusionPending[drive - numAxes];
-					}
+				// Add on the extrusion left over from last time.
+				const size_t numAxes = reprap.GetGCodes().GetTotalAxes();
+				for (size_t drive = numAxes; drive < DRIVES; ++drive)
+				{
+					nextMove.coords[drive] += extrusionPending[drive - numAxes];
+				}
 #endif
-					if (nextMove.moveType == 0)
-					{
-						AxisAndBedTransform(nextMove.coords, nextMove.xAxes, nextMove.yAxes, true);
-					}
-					if (ddaRingAddPointer->Init(nextMove, !IsRawMotorMove(nextMove.moveType)))
+				if (nextMove.moveType == 0)
+				{
+					AxisAndBedTransform(nextMove.coords, nextMove.xAxes, nextMove.yAxes, true);
+				}
+				if (ddaRingAddPointer->Init(nextMove, !IsRawMotorMove(nextMove.moveType)))
+				{
+					ddaRingAddPointer = ddaRingAddPointer->GetNext();
+					idleCount = 0;
+					scheduledMoves++;
+					if (moveState == MoveState::idle || moveState == MoveState::timing)
 					{
-						ddaRingAddPointer = ddaRingAddPointer->GetNext();
-						idleCount = 0;
-						scheduledMoves++;
-						if (moveState == MoveState::idle || moveState == MoveState::timing)
+						moveState = MoveState::collecting;
+						const uint32_t now = millis();
+						const uint32_t timeWaiting = now - lastStateChangeTime;
+						if (timeWaiting > longestGcodeWaitInterval)
 						{
-							moveState = MoveState::collecting;
-							const uint32_t now = millis();
-							const uint32_t timeWaiting = now - lastStateChangeTime;
-							if (timeWaiting > longestGcodeWaitInterval)
-							{
-								longestGcodeWaitInterval = timeWaiting;
-							}
-							lastStateChangeTime = now;
+							longestGcodeWaitInterval = timeWaiting;
 						}
+						lastStateChangeTime = now;
 					}
+				}
 #if 0	// see above
-					// Save the amount of extrusion not done
-					for (size_t drive = numAxes; drive < DRIVES; ++drive)
-					{
-						extrusionPending[drive - numAxes] = nextMove.coords[drive];
-					}
-#endif
+				// Save the amount of extrusion not done
+				for (size_t drive = numAxes; drive < DRIVES; ++drive)
+				{
+					extrusionPending[drive - numAxes] = nextMove.coords[drive];
 				}
+#endif
 			}
 		}
 	}
@@ -260,20 +262,13 @@ void Move::Spin()
 			}
 			if (dda->GetState() == DDA::frozen)
 			{
-				if (simulationMode != 0)
+				if (StartNextMove(Platform::GetInterruptClocks()))	// start the next move
 				{
-					currentDda = dda;								// pretend we are executing this move
-				}
-				else
-				{
-					if (StartNextMove(Platform::GetInterruptClocks()))	// start the next move
-					{
-						Interrupt();
-					}
+					Interrupt();
 				}
 				moveState = MoveState::executing;
 			}
-			else if (simulationMode == 0)
+			else
 			{
 				if (moveState == MoveState::executing && !reprap.GetGCodes().IsPaused())
 				{
@@ -311,7 +306,7 @@ void Move::Spin()
 		// Try to avoid preparing deceleration-only moves
 		while (st == DDA::provisional
 				&& preparedTime < (int32_t)UsualMinimumPreparedTime		// prepare moves one eighth of a second ahead of when they will be needed
-				&& preparedCount < DdaRingLength/2 - 1					// but don't prepare as much as half the ring
+				&& preparedCount < ddaRingLength/2 - 1					// but don't prepare as much as half the ring
 			  )
 		{
 			if (cdda->IsGoodToPrepare() || preparedTime < (int32_t)AbsoluteMinimumPreparedTime)
@@ -323,21 +318,101 @@ void Move::Spin()
 			cdda = cdda->GetNext();
 			st = cdda->GetState();
 		}
+	}
+
+	reprap.GetPlatform().ClassReport(longWait);
+}
+
+// Spin in simulation mode. We take moves as fast as GCodes can supply them and plan them with the usual lookahead.
+// Then we freeze each one and add its duration to the simulation time, without preparing the DMs or generating any steps.
+// Each DDA is recycled as soon as its move has been simulated, so we don't need to wait for the ring to drain.
+void Move::SpinSimulation()
+{
+	for (unsigned int movesSimulated = 0; movesSimulated < MaxSimulatedMovesPerSpin; ++movesSimulated)
+	{
+		// Recycle the DDAs of the moves we have simulated
+		while (ddaRingCheckPointer->GetState() == DDA::completed)
+		{
+			(void)ddaRingCheckPointer->Free();
+			ddaRingCheckPointer = ddaRingCheckPointer->GetNext();
+		}
+
+		// Add moves to the ring until it is full or there are no more, so that lookahead sees as many moves as it would when printing
+		bool ringFull;
+		for (;;)
+		{
+			ringFull = ddaRingAddPointer->GetState() != DDA::empty
+					|| ddaRingAddPointer->GetNext()->GetState() == DDA::provisional			// Prepare needs the endpoints of the previous move
+					|| DriveMovement::NumFree() < (int)DRIVES;
+			if (ringFull)
+			{
+				break;
+			}
+
+			if (specialMoveAvailable)
+			{
+				specialMoveAvailable = false;
+				if (ddaRingAddPointer->Init(specialMoveCoords))
+				{
+					ddaRingAddPointer = ddaRingAddPointer->GetNext();
+				}
+			}
+			else
+			{
+				GCodes::RawMove nextMove;
+				if (!reprap.GetGCodes().ReadMove(nextMove))
+				{
+					break;
+				}
+				if (simulationMode < 2)				// in simulation mode 2 and higher, we don't process incoming moves beyond this point
+				{
+					if (nextMove.moveType == 0)
+					{
+						AxisAndBedTransform(nextMove.coords, nextMove.xAxes, nextMove.yAxes, true);
+					}
+					if (ddaRingAddPointer->Init(nextMove, !IsRawMotorMove(nextMove.moveType)))
+					{
+						ddaRingAddPointer = ddaRingAddPointer->GetNext();
+						idleCount = 0;
+						scheduledMoves++;
+					}
+				}
+			}
+		}
 
-		// If we are simulating, simulate completion of the current move
-		if (simulationMode != 0)
+		// Simulate the oldest move if we can't add any more, or if GCodes has stopped sending moves because it is waiting for them to finish
+		if ((!ringFull && idleCount <= 10) || !SimulateNextMove())
 		{
-//DEBUG
-//currentDda->DebugPrint();
-			simulationTime += (float)currentDda->GetClocksNeeded()/DDA::stepClockRate;
-			currentDda->Complete();
-			CurrentMoveCompleted();
+			break;
 		}
 	}
 
 	reprap.GetPlatform().ClassReport(longWait);
 }
 
+// Simulate the oldest move in the ring, returning false if there isn't one
+bool Move::SimulateNextMove()
+{
+	DDA * const dda = ddaRingGetPointer;
+	if (dda->GetState() == DDA::provisional)
+	{
+		dda->Prepare(simulationMode);
+	}
+	if (dda->GetState() != DDA::frozen)
+	{
+		return false;
+	}
+
+	currentDda = dda;														// pretend we are executing this move
+	moveState = MoveState::executing;
+	const float moveTime = (float)dda->GetClocksNeeded()/DDA::stepClockRate;
+	simulationTime += moveTime;
+	simulationStats.MoveCompleted(*dda, moveTime);
+	dda->Complete();
+	CurrentMoveCompleted();
+	return true;
+}
+
 // Try to push some babystepping through the lookahead queue
 float Move::PushBabyStepping(float amount)
 {
@@ -556,6 +631,61 @@ extern uint32_t sqSum1, sqSum2, sqCount, sqErrors, lastRes1, lastRes2;
 extern uint64_t lastNum;
 #endif
 
+// Process M595. The caller must have waited for all movement to stop, so the ring is empty.
+// We only support increasing the queue length, because the memory we allocate for DDAs and DMs is never freed.
+GCodeResult Move::ConfigureMovementQueue(GCodeBuffer& gb, StringRef& reply)
+{
+	if (gb.Seen('P'))
+	{
+		const unsigned int newLength = gb.GetUIValue();
+		if (newLength > MaxDdaRingLength)
+		{
+			reply.printf("Movement queue length must not exceed %u", MaxDdaRingLength);
+			return GCodeResult::error;
+		}
+		if (newLength < ddaRingLength)
+		{
+			reply.copy("Movement queue length cannot be reduced");
+			return GCodeResult::error;
+		}
+
+		// Check that we have enough memory, because running out of memory would hang the board.
+		// We allocate the DDAs and DMs from the never-used RAM between the heap and the stack, which is the figure that M122 reports.
+		const unsigned int dmsWanted = newLength * DmsPerDda;
+		const unsigned int newDms = (dmsWanted > (unsigned int)DriveMovement::NumTotal()) ? dmsWanted - DriveMovement::NumTotal() : 0;
+		const uint32_t memoryNeeded = (newLength - ddaRingLength) * (sizeof(DDA) + 8) + newDms * (sizeof(DriveMovement) + 8);	// allow 8 bytes of heap overhead per object
+		uint32_t neverUsed;
+		reprap.GetPlatform().GetStackUsage(nullptr, nullptr, &neverUsed);
+		if (memoryNeeded + MovementQueueRamReserve > neverUsed)
+		{
+			reply.printf("Not enough memory for a movement queue length of %u, need %" PRIu32 " bytes but only %" PRIu32 " are free",
+							newLength, memoryNeeded + MovementQueueRamReserve, neverUsed);
+			return GCodeResult::error;
+		}
+
+		// Insert the new DDAs after the add pointer, so that the DDA before it still holds the position that the next move starts from
+		while (ddaRingLength < newLength)
+		{
+			DDA * const oldNext = ddaRingAddPointer->GetNext();
+			DDA * const dda = new DDA(oldNext);
+			dda->Init();
+			dda->SetPrevious(ddaRingAddPointer);
+			oldNext->SetPrevious(dda);
+			ddaRingAddPointer->SetNext(dda);
+			++ddaRingLength;
+		}
+		if (newDms != 0)
+		{
+			DriveMovement::InitialAllocate(newDms);
+		}
+	}
+	else
+	{
+		reply.printf("Movement queue length %u, DMs %d", ddaRingLength, DriveMovement::NumTotal());
+	}
+	return GCodeResult::ok;
+}
+
 void Move::Diagnostics(MessageType mtype)
 {
 	Platform& p = reprap.GetPlatform();
@@ -563,10 +693,17 @@ void Move::Diagnostics(MessageType mtype)
 	p.MessageF(mtype, "MaxReps: %" PRIu32 ", StepErrors: %u, LaErrors: %u, FreeDm: %d, MinFreeDm %d, MaxWait: %" PRIu32 "ms, Underruns: %u, %u\n",
 						DDA::maxReps, stepErrors, numLookaheadErrors, DriveMovement::NumFree(), DriveMovement::MinFree(), longestGcodeWaitInterval, numLookaheadUnderruns, numPrepareUnderruns);
 	DDA::maxReps = 0;
+#if DDA_TIMING_STATS
+	DDA::PrintTimingStats(mtype);
+#endif
+#if SUPPORT_INPUT_SHAPING
+	shaper.Diagnostics(mtype);
+#endif
 	numLookaheadUnderruns = numPrepareUnderruns = numLookaheadErrors = 0;
 	longestGcodeWaitInterval = 0;
 	DriveMovement::ResetMinFree();
 
+	reprap.GetPlatform().MessageF(mtype, "Movement queue length: %u\n", ddaRingLength);
 	reprap.GetPlatform().MessageF(mtype, "Scheduled moves: %" PRIu32 ", completed moves: %" PRIu32 "\n", scheduledMoves, completedMoves);
 
 #if defined(__ALLIGATOR__)
@@ -891,6 +1028,20 @@ void Move::SetAxisCompensation(unsigned int axis, float tangent)
 	}
 }
 
+#if SUPPORT_NATIVE_ARCS
+
+// Return true if arc moves can be executed without segmenting them.
+// This requires each of the X and Y motors to follow the corresponding coordinate, so no kinematic transform, axis skew compensation or bed compensation.
+bool Move::CanDoNativeArcs() const
+{
+	return kinematics->GetKinematicsType() == KinematicsType::cartesian
+		&& !usingMesh
+		&& probePoints.GetNumBedCompensationPoints() == 0
+		&& tanXY == 0.0 && tanYZ == 0.0 && tanXZ == 0.0;
+}
+
+#endif
+
 // Calibrate or set the bed equation after probing, returning true if an error occurred
 // sParam is the value of the S parameter in the G30 command that provoked this call.
 // Caller already owns the GCode movement lock.
@@ -1156,11 +1307,16 @@ float Move::GetProbeCoordinates(int count, float& x, float& y, bool wantNozzlePo
 // Enter or leave simulation mode
 void Move::Simulate(uint8_t simMode)
 {
-	simulationMode = simMode;
 	if (simMode != 0)
 	{
 		simulationTime = 0.0;
+		simulationStats.Reset();
+	}
+	else if (simulationMode != 0)
+	{
+		simulationStats.Finished();
 	}
+	simulationMode = simMode;
 }
 
 // Adjust the leadscrews
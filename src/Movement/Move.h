@@ -14,6 +14,8 @@
 #include "BedProbing/RandomProbePointSet.h"
 #include "BedProbing/Grid.h"
 #include "Kinematics/Kinematics.h"
+#include "InputShaper.h"
+#include "SimulationStats.h"
 #include "GCodes/RestorePoint.h"
 
 // Define the number of DDAs and DMs.
@@ -23,12 +25,16 @@
 
 #if SAM4E || SAM4S || SAME70
 const unsigned int DdaRingLength = 30;
-const unsigned int NumDms = DdaRingLength * 8;						// suitable for e.g. a delta + 5 input hot end
+const unsigned int DmsPerDda = 8;									// suitable for e.g. a delta + 5 input hot end
+const unsigned int MaxDdaRingLength = 120;							// the most that M595 lets the user configure
 #else
 // We are more memory-constrained on the SAM3X
 const unsigned int DdaRingLength = 20;
-const unsigned int NumDms = DdaRingLength * 5;						// suitable for e.g. a delta + 2-input hot end
+const unsigned int DmsPerDda = 5;									// suitable for e.g. a delta + 2-input hot end
+const unsigned int MaxDdaRingLength = 40;
 #endif
+const unsigned int NumDms = DdaRingLength * DmsPerDda;
+const uint32_t MovementQueueRamReserve = 4096;						// how much never-used RAM M595 must leave for the stack and other allocations
 
 /**
  * This is the master movement class.  It controls all movement in the machine.
@@ -67,10 +73,18 @@ public:
 	void SetTaperHeight(float h);
 	bool UseMesh(bool b);											// Try to enable mesh bed compensation and report the final state
 	bool IsUsingMesh() const { return usingMesh; }					// Return true if we are using mesh compensation
+#if SUPPORT_NATIVE_ARCS
+	bool CanDoNativeArcs() const;									// Return true if arc moves can be executed without segmenting them
+#endif
 	float PushBabyStepping(float amount);							// Try to push some babystepping through the lookahead queue
 
 	void Diagnostics(MessageType mtype);							// Report useful stuff
+	GCodeResult ConfigureMovementQueue(GCodeBuffer& gb, StringRef& reply);	// Process M595
 	void RecordLookaheadError() { ++numLookaheadErrors; }			// Record a lookahead error
+#if SUPPORT_INPUT_SHAPING
+	InputShaper& GetShaper() { return shaper; }
+	const InputShaper& GetShaper() const { return shaper; }
+#endif
 
 	// Kinematics and related functions
 	Kinematics& GetKinematics() const { return *kinematics; }
@@ -97,6 +111,7 @@ public:
 
 	void Simulate(uint8_t simMode);													// Enter or leave simulation mode
 	float GetSimulationTime() const { return simulationTime; }						// Get the accumulated simulation time
+	SimulationStats& GetSimulationStats() { return simulationStats; }				// Get the breakdown of the simulation time
 	void PrintCurrentDda() const;													// For debugging
 
 	bool PausePrint(RestorePoint& rp);												// Pause the print as soon as we can, returning true if we were able to
@@ -115,6 +130,7 @@ public:
 	HeightMap& AccessHeightMap() { return heightMap; }								// Access the bed probing grid
 
 	const DDA *GetCurrentDDA() const { return currentDda; }							// Return the DDA of the currently-executing move
+	FilePosition GetExecutingFilePosition() const;									// Return the file position of the currently-executing move, or noFilePosition
 
 	void AdjustLeadscrews(const floatc_t corrections[]);							// Called by some Kinematics classes to adjust the leadscrews
 
@@ -139,6 +155,8 @@ private:
 	};
 
 	bool StartNextMove(uint32_t startTime) __attribute__ ((hot));								// Start the next move, returning true if Step() needs to be called immediately
+	void SpinSimulation();																		// Spin when we are simulating
+	bool SimulateNextMove();																	// Simulate the oldest move in the ring, returning false if there isn't one
 	void BedTransform(float move[MaxAxes], AxesBitmap xAxes, AxesBitmap yAxes) const;			// Take a position and apply the bed compensations
 	void InverseBedTransform(float move[MaxAxes], AxesBitmap xAxes, AxesBitmap yAxes) const;	// Go from a bed-transformed point back to user coordinates
 	void AxisTransform(float move[MaxAxes], AxesBitmap xAxes, AxesBitmap yAxes) const;			// Take a position and apply the axis-angle compensations
@@ -153,6 +171,7 @@ private:
 	DDA* ddaRingAddPointer;
 	DDA* volatile ddaRingGetPointer;
 	DDA* ddaRingCheckPointer;
+	unsigned int ddaRingLength;							// How many DDAs there are in the ring
 
 	bool active;										// Are we live and running?
 	uint8_t simulationMode;								// Are we simulating, or really printing?
@@ -164,6 +183,7 @@ private:
 	unsigned int idleCount;								// The number of times Spin was called and had no new moves to process
 	uint32_t longestGcodeWaitInterval;					// the longest we had to wait for a new GCode
 	float simulationTime;								// Print time since we started simulating
+	SimulationStats simulationStats;					// Breakdown of the simulated print time by feature and layer
 
 	float extrusionPending[MaxExtruders];				// Extrusion not done due to rounding to nearest step
 	volatile float liveCoordinates[DRIVES];				// The endpoint that the machine moved to in the last completed move
@@ -189,6 +209,9 @@ private:
 	uint32_t longWait;									// A long time for things that need to be done occasionally
 
 	Kinematics *kinematics;								// What kinematics we are using
+#if SUPPORT_INPUT_SHAPING
+	InputShaper shaper;									// The input shaping configuration
+#endif
 
 	unsigned int stepErrors;							// count of step errors, for diagnostics
 	uint32_t scheduledMoves;							// Move counters for the code queue
@@ -239,6 +262,12 @@ inline void Move::Interrupt()
 	}
 }
 
+inline FilePosition Move::GetExecutingFilePosition() const
+{
+	const DDA * const cdda = currentDda;		// capture volatile variable
+	return (cdda != nullptr) ? cdda->GetFilePosition() : noFilePosition;
+}
+
 #if HAS_SMART_DRIVERS
 
 // Get the current step interval for this axis or extruder, or 0 if it is not moving
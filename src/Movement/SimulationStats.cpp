@@ -0,0 +1,141 @@
+/*
+ * SimulationStats.cpp
+ *
+ *  Created on: 16 Oct 2026
+ *      Author: agent
+ */
+
+#include "SimulationStats.h"
+#include "DDA.h"
+#include "RepRap.h"
+#include "Platform.h"
+#include "GCodes/GCodes.h"
+
+SimulationStats::SimulationStats() : layerLog(nullptr)
+{
+	Reset();
+}
+
+// Clear the statistics and close any layer log
+void SimulationStats::Reset()
+{
+	SetLayerLog(nullptr);
+	for (float& t : featureTimes)
+	{
+		t = 0.0;
+	}
+	totalTime = layerZ = layerStartTime = 0.0;
+	shortestLayerTime = longestLayerTime = 0.0;
+	numLayers = shortestLayer = longestLayer = 0;
+}
+
+// Write the details of each layer to this file. We close the file when the simulation finishes or is reset.
+void SimulationStats::SetLayerLog(FileStore *f)
+{
+	if (layerLog != nullptr)
+	{
+		layerLog->Close();
+	}
+	layerLog = f;
+	if (layerLog != nullptr && !layerLog->Write("layer,z,start,time\n"))
+	{
+		layerLog->Close();
+		layerLog = nullptr;
+	}
+}
+
+// Add a simulated move
+void SimulationStats::MoveCompleted(DDA& dda, float moveTime)
+{
+	SimulatedFeature feature;
+	if (dda.IsPrintingMove())
+	{
+		feature = SimulatedFeature::printing;
+		const float z = dda.GetEndCoordinate(Z_AXIS, false);
+		if (numLayers == 0 || z >= layerZ + MinLayerHeight)
+		{
+			if (numLayers != 0)
+			{
+				EndLayer();
+			}
+			++numLayers;
+			layerZ = z;
+			layerStartTime = totalTime;
+		}
+	}
+	else if (dda.IsXYMoving())
+	{
+		feature = SimulatedFeature::travel;
+	}
+	else
+	{
+		feature = SimulatedFeature::other;
+		const int32_t * const endPoints = dda.DriveCoordinates();
+		for (size_t drive = reprap.GetGCodes().GetTotalAxes(); drive < DRIVES; ++drive)
+		{
+			if (endPoints[drive] != 0)					// extruder end points are relative to the start of the move
+			{
+				feature = SimulatedFeature::retraction;
+				break;
+			}
+		}
+	}
+
+	featureTimes[(size_t)feature] += moveTime;
+	totalTime += moveTime;
+}
+
+// Finish the last layer and close the layer log
+void SimulationStats::Finished()
+{
+	if (numLayers != 0)
+	{
+		EndLayer();
+	}
+	SetLayerLog(nullptr);
+}
+
+// Record the time of the current layer
+void SimulationStats::EndLayer()
+{
+	const float layerTime = totalTime - layerStartTime;
+	if (numLayers == 1 || layerTime < shortestLayerTime)
+	{
+		shortestLayerTime = layerTime;
+		shortestLayer = numLayers;
+	}
+	if (numLayers == 1 || layerTime > longestLayerTime)
+	{
+		longestLayerTime = layerTime;
+		longestLayer = numLayers;
+	}
+
+	if (layerLog != nullptr)
+	{
+		String<40> line;
+		line.GetRef().printf("%u,%.3f,%.1f,%.1f\n", numLayers, (double)layerZ, (double)layerStartTime, (double)layerTime);
+		if (!layerLog->Write(line.c_str()))
+		{
+			SetLayerLog(nullptr);
+		}
+	}
+}
+
+// Append the breakdown of the simulated time to a reply
+void SimulationStats::AppendReport(const StringRef& reply) const
+{
+	reply.catf("printing %.1f sec, travel %.1f sec, retraction %.1f sec, other %.1f sec",
+				(double)featureTimes[(size_t)SimulatedFeature::printing], (double)featureTimes[(size_t)SimulatedFeature::travel],
+				(double)featureTimes[(size_t)SimulatedFeature::retraction], (double)featureTimes[(size_t)SimulatedFeature::other]);
+	if (numLayers != 0)
+	{
+		reply.catf(", %u layers", numLayers);
+		if (shortestLayer != 0)
+		{
+			reply.catf(", shortest %.1f sec (layer %u), longest %.1f sec (layer %u)",
+						(double)shortestLayerTime, shortestLayer, (double)longestLayerTime, longestLayer);
+		}
+	}
+}
+
+// End
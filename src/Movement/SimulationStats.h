@@ -0,0 +1,55 @@
+/*
+ * SimulationStats.h
+ *
+ *  Created on: 16 Oct 2026
+ *      Author: agent
+ */
+
+#ifndef SRC_MOVEMENT_SIMULATIONSTATS_H_
+#define SRC_MOVEMENT_SIMULATIONSTATS_H_
+
+#include "RepRapFirmware.h"
+
+// The kinds of move that we break the simulated print time down into
+enum class SimulatedFeature : uint8_t
+{
+	printing = 0,		// XY movement with extrusion
+	travel,				// XY movement without extrusion
+	retraction,			// extrusion or retraction without XY movement
+	other,				// anything else, e.g. Z hops and moves of other axes
+	numFeatures
+};
+
+// Class to accumulate the time of simulated moves by feature and by layer.
+// A layer starts at the first printing move that is higher than the start of the previous layer by at least MinLayerHeight.
+// The details of each layer can optionally be written to a CSV file as the simulation runs, so that we don't need any memory per layer.
+class SimulationStats
+{
+public:
+	SimulationStats();
+
+	void Reset();													// Clear the statistics and close any layer log
+	void SetLayerLog(FileStore *f);									// Write the details of each layer to this file, which we close when the simulation finishes
+	void MoveCompleted(DDA& dda, float moveTime);					// Add a simulated move
+	void Finished();												// Finish the last layer and close the layer log
+
+	float GetTotalTime() const { return totalTime; }
+	unsigned int GetNumLayers() const { return numLayers; }
+	void AppendReport(const StringRef& reply) const;				// Append the breakdown of the simulated time to a reply
+
+private:
+	void EndLayer();
+
+	static constexpr float MinLayerHeight = 0.02;
+
+	float featureTimes[(size_t)SimulatedFeature::numFeatures];
+	float totalTime;
+	float layerZ;													// the height of the current layer
+	float layerStartTime;											// the simulated time at which the current layer started
+	float shortestLayerTime, longestLayerTime;
+	unsigned int numLayers;											// the number of layers started, so the current layer number
+	unsigned int shortestLayer, longestLayer;
+	FileStore *layerLog;
+};
+
+#endif /* SRC_MOVEMENT_SIMULATIONSTATS_H_ */
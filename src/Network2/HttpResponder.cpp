@@ -494,8 +494,11 @@ bool HttpResponder::GetJsonResponse(const char* request, OutputBuffer *&response
 				type = 1;
 			}
 
+			// If the client passes the statusSeq value from its last response then we only send what has changed since then
+			const char* const sinceVal = GetKeyValue("since");
+			const uint32_t since = (sinceVal == nullptr) ? 0 : strtoul(sinceVal, nullptr, 10);
 			OutputBuffer::Release(response);
-			response = reprap.GetStatusResponse(type, ResponseSource::HTTP);
+			response = reprap.GetStatusResponse(type, ResponseSource::HTTP, since);
 		}
 		else
 		{
@@ -521,8 +524,12 @@ bool HttpResponder::GetJsonResponse(const char* request, OutputBuffer *&response
 	}
 	else if (StringEquals(request, "filelist") && GetKeyValue("dir") != nullptr)
 	{
+		const char* const firstVal = GetKeyValue("first");
+		const unsigned int startAt = (firstVal == nullptr) ? 0 : strtoul(firstVal, nullptr, 10);
 		OutputBuffer::Release(response);
-		response = reprap.GetFilelistResponse(GetKeyValue("dir"));
+		response = nullptr;
+		fileListGenerator.Start(GetKeyValue("dir"), startAt, FileListGenerator::ListType::filelist);
+		generator = &fileListGenerator;
 	}
 	else if (StringEquals(request, "files"))
 	{
@@ -533,8 +540,12 @@ bool HttpResponder::GetJsonResponse(const char* request, OutputBuffer *&response
 		}
 		const char* const flagDirsVal = GetKeyValue("flagDirs");
 		const bool flagDirs = flagDirsVal != nullptr && atoi(flagDirsVal) == 1;
+		const char* const firstVal = GetKeyValue("first");
+		const unsigned int startAt = (firstVal == nullptr) ? 0 : strtoul(firstVal, nullptr, 10);
 		OutputBuffer::Release(response);
-		response = reprap.GetFilesResponse(dir, flagDirs);
+		response = nullptr;
+		fileListGenerator.Start(dir, startAt, (flagDirs) ? FileListGenerator::ListType::filesFlagDirs : FileListGenerator::ListType::files);
+		generator = &fileListGenerator;
 	}
 	else if (StringEquals(request, "fileinfo"))
 	{
@@ -927,7 +938,15 @@ void HttpResponder::SendJsonResponse(const char* command)
 					"Access-Control-Allow-Origin: *\n"
 					"Content-Type: application/json\n"
 				);
-	outBuf->catf("Content-Length: %u\n", (jsonResponse != nullptr) ? jsonResponse->Length() : 0);
+	if (generator != nullptr)
+	{
+		// We don't know how long the response will be, so send it in chunks as we generate it
+		outBuf->cat("Transfer-Encoding: chunked\n");
+	}
+	else
+	{
+		outBuf->catf("Content-Length: %u\n", (jsonResponse != nullptr) ? jsonResponse->Length() : 0);
+	}
 	outBuf->catf("Connection: %s\n\n", keepOpen ? "keep-alive" : "close");
 	outBuf->Append(jsonResponse);
 
@@ -1182,6 +1201,43 @@ void HttpResponder::SendData()
 	}
 }
 
+// This overrides the version in class NetworkResponder. We send generated responses using chunked transfer encoding.
+bool HttpResponder::GetMoreData()
+{
+	// Get both buffers before we generate anything, so that we can't lose part of the response
+	if (!OutputBuffer::Allocate(outBuf))
+	{
+		return false;
+	}
+	OutputBuffer *chunk;
+	if (!OutputBuffer::Allocate(chunk))
+	{
+		OutputBuffer::Release(outBuf);
+		outBuf = nullptr;
+		return false;
+	}
+
+	const bool more = generator->GetNextChunk(chunk, ResponseChunkSize);
+	const size_t chunkLength = chunk->Length();
+	if (chunkLength != 0)
+	{
+		outBuf->printf("%x\r\n", (unsigned int)chunkLength);
+		outBuf->Append(chunk);
+		outBuf->cat("\r\n");
+	}
+	else
+	{
+		OutputBuffer::Release(chunk);
+	}
+
+	if (!more)
+	{
+		outBuf->cat("0\r\n\r\n");						// the last chunk
+		generator = nullptr;
+	}
+	return true;
+}
+
 void HttpResponder::Diagnostics(MessageType mt) const
 {
 	GetPlatform().MessageF(mt, " HTTP(%d)", (int)responderState);
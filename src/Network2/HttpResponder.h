@@ -9,6 +9,7 @@
 #define SRC_DUETNG_DUETETHERNET_HTTPRESPONDER_H_
 
 #include "NetworkResponder.h"
+#include "FileListGenerator.h"
 
 class HttpResponder : public NetworkResponder
 {
@@ -29,6 +30,7 @@ protected:
 	void ConnectionLost() override;
 	void CancelUpload() override;
 	void SendData() override;
+	bool GetMoreData() override;
 
 private:
 	static const size_t MaxHttpSessions = 8;			// maximum number of simultaneous HTTP sessions
@@ -104,6 +106,9 @@ private:
 	// rr_fileinfo requests
 	char filenameBeingProcessed[FILENAME_LENGTH];	// The filename being processed (for rr_fileinfo)
 
+	// rr_files and rr_filelist requests, which we send a few entries at a time
+	FileListGenerator fileListGenerator;
+
 	// Keeping track of HTTP sessions
 	static HttpSession sessions[MaxHttpSessions];
 	static unsigned int numSessions;
@@ -41,7 +41,7 @@ void NetworkResponderLock::Release(const NetworkResponder *who)
 
 NetworkResponder::NetworkResponder(NetworkResponder *n)
 	: next(n), responderState(ResponderState::free), skt(nullptr),
-	  outBuf(nullptr), outStack(new OutputStack), fileBeingSent(nullptr), fileBuffer(nullptr)
+	  outBuf(nullptr), outBufPos(0), outStack(new OutputStack), fileBeingSent(nullptr), fileBuffer(nullptr), generator(nullptr)
 {
 }
 
@@ -57,7 +57,7 @@ void NetworkResponder::Commit(ResponderState nextState)
 }
 
 // Send our data.
-// We send outBuf first, then outStack, and finally fileBeingSent.
+// We send outBuf first, then outStack, then the output of the response generator, and finally fileBeingSent.
 void NetworkResponder::SendData()
 {
 	// Send our output buffer and output stack
@@ -68,17 +68,27 @@ void NetworkResponder::SendData()
 			outBuf = outStack->Pop();
 			if (outBuf == nullptr)
 			{
-				break;
+				if (generator == nullptr)
+				{
+					break;
+				}
+				if (!GetMoreData())
+				{
+					return;				// no buffer available, try again later
+				}
+				continue;
 			}
 		}
-		const size_t bytesLeft = outBuf->BytesLeft();
+		// Status responses and G-code replies may be shared with other responders, so we keep our own place in the buffer instead of using its read pointer
+		const size_t bytesLeft = outBuf->DataLength() - outBufPos;
 		if (bytesLeft == 0)
 		{
 			outBuf = OutputBuffer::Release(outBuf);
+			outBufPos = 0;
 		}
 		else
 		{
-			const size_t sent = skt->Send(reinterpret_cast<const uint8_t *>(outBuf->UnreadData()), bytesLeft);
+			const size_t sent = skt->Send(reinterpret_cast<const uint8_t *>(outBuf->Data() + outBufPos), bytesLeft);
 			if (sent == 0)
 			{
 				// Check whether the connection has been closed
@@ -94,12 +104,13 @@ void NetworkResponder::SendData()
 				return;
 			}
 
-			outBuf->Taken(sent);				// tell the output buffer how much data we have taken
+			outBufPos += sent;
 			if (sent < bytesLeft)
 			{
 				return;
 			}
 			outBuf = OutputBuffer::Release(outBuf);
+			outBufPos = 0;
 		}
 	}
 
@@ -172,13 +183,29 @@ void NetworkResponder::SendData()
 	responderState = stateAfterSending;
 }
 
+// Put the next part of the generated response in outBuf, returning false if we couldn't get a buffer. Overridden in some derived classes.
+bool NetworkResponder::GetMoreData()
+{
+	if (!OutputBuffer::Allocate(outBuf))
+	{
+		return false;
+	}
+	if (!generator->GetNextChunk(outBuf, ResponseChunkSize))
+	{
+		generator = nullptr;
+	}
+	return true;
+}
+
 // This is called when we lose a connection or when we are asked to terminate. Overridden in some derived classes.
 void NetworkResponder::ConnectionLost()
 {
 	CancelUpload();
 	OutputBuffer::ReleaseAll(outBuf);
 	outBuf = nullptr;
+	outBufPos = 0;
 	outStack->ReleaseAll();
+	generator = nullptr;
 
 	if (fileBeingSent != nullptr)
 	{
@@ -14,6 +14,7 @@
 #include "Socket.h"
 #include "Storage/FileData.h"
 #include "NetworkBuffer.h"
+#include "ResponseGenerator.h"
 
 // Forward declarations
 class NetworkResponder;
@@ -70,6 +71,7 @@ protected:
 
 	void Commit(ResponderState nextState = ResponderState::free);
 	virtual void SendData();
+	virtual bool GetMoreData();
 	virtual void ConnectionLost();
 
 	void StartUpload(FileStore *file, const char *fileName);
@@ -90,9 +92,11 @@ protected:
 
 	// Buffers for sending responses
 	OutputBuffer *outBuf;
+	size_t outBufPos;									// how much of outBuf we have sent
 	OutputStack *outStack;
 	FileStore *fileBeingSent;
 	NetworkBuffer *fileBuffer;
+	ResponseGenerator *generator;						// if not null, we get the rest of the response from this after sending outBuf and outStack
 
 	// File uploads
 	FileData fileBeingUploaded;
@@ -10,9 +10,9 @@
 #include "RepRap.h"
 #include <cstdarg>
 
-/*static*/ OutputBuffer * volatile OutputBuffer::freeOutputBuffers = nullptr;		// Messages may also be sent by ISRs,
-/*static*/ volatile size_t OutputBuffer::usedOutputBuffers = 0;						// so make these volatile.
-/*static*/ volatile size_t OutputBuffer::maxUsedOutputBuffers = 0;
+/*static*/ OutputBuffer * volatile OutputBuffer::freeOutputBuffers[NumSizeClasses] = { nullptr };	// Messages may also be sent by ISRs,
+/*static*/ volatile size_t OutputBuffer::usedOutputBuffers[NumSizeClasses] = { 0 };						// so make these volatile.
+/*static*/ volatile size_t OutputBuffer::maxUsedOutputBuffers[NumSizeClasses] = { 0 };
 
 //*************************************************************************************************
 // OutputBuffer class implementation
@@ -156,11 +156,11 @@ size_t OutputBuffer::copy(const char *src, size_t len)
 size_t OutputBuffer::cat(const char c)
 {
 	// See if we can append a char
-	if (last->dataLength == OUTPUT_BUFFER_SIZE)
+	if (last->dataLength == last->capacity)
 	{
-		// No - allocate a new item and copy the data
+		// No - allocate a new item and copy the data. If this is already a long chain then it is probably a long response, so try to use a large buffer.
 		OutputBuffer *nextBuffer;
-		if (!Allocate(nextBuffer))
+		if (!Allocate(nextBuffer, next != nullptr))
 		{
 			// We cannot store any more data. Should never happen
 			return 0;
@@ -193,11 +193,11 @@ size_t OutputBuffer::cat(const char *src, size_t len)
 	size_t copied = 0;
 	while (copied < len)
 	{
-		if (last->dataLength == OUTPUT_BUFFER_SIZE)
+		if (last->dataLength == last->capacity)
 		{
-			// The last buffer is full
+			// The last buffer is full. If this is already a long chain then it is probably a long response, so try to use a large buffer.
 			OutputBuffer *nextBuffer;
-			if (!Allocate(nextBuffer))
+			if (!Allocate(nextBuffer, next != nullptr))
 			{
 				// We cannot store any more data, stop here
 				break;
@@ -210,7 +210,7 @@ size_t OutputBuffer::cat(const char *src, size_t len)
 				item->last = last;
 			}
 		}
-		const size_t copyLength = min<size_t>(len - copied, OUTPUT_BUFFER_SIZE - last->dataLength);
+		const size_t copyLength = min<size_t>(len - copied, last->capacity - last->dataLength);
 		memcpy(last->data + last->dataLength, src + copied, copyLength);
 		last->dataLength += copyLength;
 		copied += copyLength;
@@ -223,6 +223,84 @@ size_t OutputBuffer::cat(StringRef &str)
 	return cat(str.Pointer(), str.Length());
 }
 
+// Number formatting. The status responses contain a lot of numbers, so we format them here instead of going through vsnprintf.
+
+static const uint32_t PowersOfTen[] = { 1, 10, 100, 1000, 10000 };
+
+// Append an unsigned integer in decimal and return the number of bytes written
+size_t OutputBuffer::CatUnsigned(uint32_t value)
+{
+	char digits[10];
+	char *p = digits + ARRAY_SIZE(digits);
+	do
+	{
+		*--p = '0' + (char)(value % 10);
+		value /= 10;
+	} while (value != 0);
+	return cat(p, digits + ARRAY_SIZE(digits) - p);
+}
+
+// Append a signed integer in decimal and return the number of bytes written
+size_t OutputBuffer::CatSigned(int32_t value)
+{
+	if (value < 0)
+	{
+		return cat('-') + CatUnsigned((uint32_t)0 - (uint32_t)value);
+	}
+	return CatUnsigned((uint32_t)value);
+}
+
+// Append a float with the specified number of decimal places, giving the same result as "%.Nf" in almost all cases.
+// We scale only the fractional part so that the rounding error is tiny, but a value that is within about one part in 10^7 of halfway
+// between two outputs may still round the other way. Values that are too large, NaNs and infinities are passed to catf.
+size_t OutputBuffer::CatFloat(float value, unsigned int decimalPlaces)
+{
+	const float absValue = fabsf(value);
+	if (decimalPlaces >= ARRAY_SIZE(PowersOfTen) || !(absValue < 1.0e9))
+	{
+		return catf("%.*f", (int)decimalPlaces, (double)value);
+	}
+
+	uint32_t intPart, fracPart;
+	if (decimalPlaces == 0)
+	{
+		intPart = (uint32_t)lrintf(absValue);
+		fracPart = 0;
+	}
+	else
+	{
+		intPart = (uint32_t)absValue;
+		fracPart = (uint32_t)lrintf((absValue - (float)intPart) * (float)PowersOfTen[decimalPlaces]);
+		if (fracPart >= PowersOfTen[decimalPlaces])
+		{
+			fracPart -= PowersOfTen[decimalPlaces];
+			++intPart;
+		}
+	}
+
+	char digits[16];
+	char *p = digits + ARRAY_SIZE(digits);
+	for (unsigned int i = 0; i < decimalPlaces; ++i)
+	{
+		*--p = '0' + (char)(fracPart % 10);
+		fracPart /= 10;
+	}
+	if (decimalPlaces != 0)
+	{
+		*--p = '.';
+	}
+	do
+	{
+		*--p = '0' + (char)(intPart % 10);
+		intPart /= 10;
+	} while (intPart != 0);
+	if (value < 0.0)
+	{
+		*--p = '-';
+	}
+	return cat(p, digits + ARRAY_SIZE(digits) - p);
+}
+
 // Encode a string in JSON format and append it to a string buffer and return the number of bytes written
 size_t OutputBuffer::EncodeString(const char *src, size_t srcLength, bool allowControlChars, bool encapsulateString)
 {
@@ -330,34 +408,50 @@ bool OutputBuffer::WriteToFile(FileData& f) const
 // Initialise the output buffers manager
 /*static*/ void OutputBuffer::Init()
 {
-	freeOutputBuffers = nullptr;
+	freeOutputBuffers[SmallBuffers] = freeOutputBuffers[LargeBuffers] = nullptr;
 	for (size_t i = 0; i < OUTPUT_BUFFER_COUNT; i++)
 	{
-		freeOutputBuffers = new OutputBuffer(freeOutputBuffers);
+		freeOutputBuffers[SmallBuffers] = new OutputBuffer(freeOutputBuffers[SmallBuffers], new char[OUTPUT_BUFFER_SIZE], OUTPUT_BUFFER_SIZE);
+	}
+	for (size_t i = 0; i < LARGE_OUTPUT_BUFFER_COUNT; i++)
+	{
+		freeOutputBuffers[LargeBuffers] = new OutputBuffer(freeOutputBuffers[LargeBuffers], new char[LARGE_OUTPUT_BUFFER_SIZE], LARGE_OUTPUT_BUFFER_SIZE);
 	}
 }
 
-// Allocates an output buffer instance which can be used for (large) string outputs
-/*static*/ bool OutputBuffer::Allocate(OutputBuffer *&buf)
+// Allocates an output buffer instance which can be used for (large) string outputs.
+// If preferLarge is true then we use a large buffer if there is one free, else a small one. Otherwise we do it the other way round.
+// Once the free small buffers are down to the reserve we always prefer a large one, because GetBytesLeft counts on the reserve being kept for the response headers.
+/*static*/ bool OutputBuffer::Allocate(OutputBuffer *&buf, bool preferLarge)
 {
 	const irqflags_t flags = cpu_irq_save();
 
-	if (freeOutputBuffers == nullptr)
+	if (OUTPUT_BUFFER_COUNT - usedOutputBuffers[SmallBuffers] <= RESERVED_OUTPUT_BUFFERS)
 	{
-		reprap.GetPlatform().LogError(ErrorCode::OutputStarvation);
-		cpu_irq_restore(flags);
+		preferLarge = true;
+	}
 
-		buf = nullptr;
-		return false;
+	size_t sizeClass = (preferLarge) ? LargeBuffers : SmallBuffers;
+	if (freeOutputBuffers[sizeClass] == nullptr)
+	{
+		sizeClass = (preferLarge) ? SmallBuffers : LargeBuffers;
+		if (freeOutputBuffers[sizeClass] == nullptr)
+		{
+			reprap.GetPlatform().LogError(ErrorCode::OutputStarvation);
+			cpu_irq_restore(flags);
+
+			buf = nullptr;
+			return false;
+		}
 	}
 
-	buf = freeOutputBuffers;
-	freeOutputBuffers = buf->next;
+	buf = freeOutputBuffers[sizeClass];
+	freeOutputBuffers[sizeClass] = buf->next;
 
-	usedOutputBuffers++;
-	if (usedOutputBuffers > maxUsedOutputBuffers)
+	usedOutputBuffers[sizeClass]++;
+	if (usedOutputBuffers[sizeClass] > maxUsedOutputBuffers[sizeClass])
 	{
-		maxUsedOutputBuffers = usedOutputBuffers;
+		maxUsedOutputBuffers[sizeClass] = usedOutputBuffers[sizeClass];
 	}
 
 	buf->next = nullptr;
@@ -373,15 +467,16 @@ bool OutputBuffer::WriteToFile(FileData& f) const
 // Get the number of bytes left for continuous writing
 /*static*/ size_t OutputBuffer::GetBytesLeft(const OutputBuffer *writingBuffer)
 {
-	const size_t freeOutputBuffers = OUTPUT_BUFFER_COUNT - usedOutputBuffers;
+	const size_t freeOutputBuffers = OUTPUT_BUFFER_COUNT - usedOutputBuffers[SmallBuffers];
+	const size_t freeLargeBytes = (LARGE_OUTPUT_BUFFER_COUNT - usedOutputBuffers[LargeBuffers]) * LARGE_OUTPUT_BUFFER_SIZE;
 	if (writingBuffer == nullptr)
 	{
 		// Only return the total number of bytes left
-		return freeOutputBuffers * OUTPUT_BUFFER_SIZE;
+		return freeOutputBuffers * OUTPUT_BUFFER_SIZE + freeLargeBytes;
 	}
 
 	// We're doing a possibly long response like a filelist
-	const size_t bytesLeft = OUTPUT_BUFFER_SIZE - writingBuffer->last->DataLength();
+	const size_t bytesLeft = writingBuffer->last->capacity - writingBuffer->last->DataLength() + freeLargeBytes;
 
 	if (freeOutputBuffers < RESERVED_OUTPUT_BUFFERS)
 	{
@@ -418,8 +513,8 @@ bool OutputBuffer::WriteToFile(FileData& f) const
 
 		// Unlink and free the last entry
 		previousItem->next = nullptr;
+		releasedBytes += lastItem->capacity;
 		Release(lastItem);
-		releasedBytes += OUTPUT_BUFFER_SIZE;
 	} while (previousItem != buffer && releasedBytes < bytesNeeded);
 
 	// Update all the references to the last item
@@ -445,10 +540,11 @@ bool OutputBuffer::WriteToFile(FileData& f) const
 		return nextBuffer;
 	}
 
-	// Otherwise prepend it to the list of free output buffers again
-	buf->next = freeOutputBuffers;
-	freeOutputBuffers = buf;
-	usedOutputBuffers--;
+	// Otherwise prepend it to the list of free output buffers of its size again
+	const size_t sizeClass = buf->SizeClass();
+	buf->next = freeOutputBuffers[sizeClass];
+	freeOutputBuffers[sizeClass] = buf;
+	usedOutputBuffers[sizeClass]--;
 
 	cpu_irq_restore(flags);
 	return nextBuffer;
@@ -464,8 +560,9 @@ bool OutputBuffer::WriteToFile(FileData& f) const
 
 /*static*/ void OutputBuffer::Diagnostics(MessageType mtype)
 {
-	reprap.GetPlatform().MessageF(mtype, "Used output buffers: %d of %d (%d max)\n",
-			usedOutputBuffers, OUTPUT_BUFFER_COUNT, maxUsedOutputBuffers);
+	reprap.GetPlatform().MessageF(mtype, "Used output buffers: %d of %d (%d max), large %d of %d (%d max)\n",
+			usedOutputBuffers[SmallBuffers], OUTPUT_BUFFER_COUNT, maxUsedOutputBuffers[SmallBuffers],
+			usedOutputBuffers[LargeBuffers], LARGE_OUTPUT_BUFFER_COUNT, maxUsedOutputBuffers[LargeBuffers]);
 }
 
 //*************************************************************************************************
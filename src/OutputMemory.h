@@ -17,12 +17,14 @@ const size_t OUTPUT_STACK_DEPTH = 4;	// Number of OutputBuffer chains that can b
 class OutputStack;
 
 // This class is used to hold data for sending (either for Serial or Network destinations)
+// There are two sizes of buffer. Short messages use the small ones. Long responses are built from the few large ones as far as possible,
+// so that they don't use up the small buffers that the G-code replies need.
 class OutputBuffer
 {
 	public:
 		friend class OutputStack;
 
-		OutputBuffer(OutputBuffer *n) : next(n) { }
+		OutputBuffer(OutputBuffer *n, char *d, size_t cap) : next(n), data(d), capacity(cap) { }
 
 		void Append(OutputBuffer *other);
 		OutputBuffer *Next() const { return next; }
@@ -53,6 +55,10 @@ class OutputBuffer
 		size_t cat(const char *src, size_t len);
 		size_t cat(StringRef &str);
 
+		size_t CatUnsigned(uint32_t value);
+		size_t CatSigned(int32_t value);
+		size_t CatFloat(float value, unsigned int decimalPlaces);	// Like catf("%.*f") but much faster
+
 		size_t EncodeString(const char *src, size_t srcLength, bool allowControlChars, bool encapsulateString = true);
 		size_t EncodeReply(OutputBuffer *src, bool allowControlChars);
 
@@ -65,7 +71,8 @@ class OutputBuffer
 		static void Init();
 
 		// Allocate an unused OutputBuffer instance. Returns true on success or false if no instance could be allocated.
-		static bool Allocate(OutputBuffer *&buf);
+		// We use a small buffer if there is one free, else a large one.
+		static bool Allocate(OutputBuffer *&buf) { return Allocate(buf, false); }
 
 		// Get the number of bytes left for allocation. If writingBuffer is not NULL, this returns the number of free bytes for
 		// continuous writes, i.e. for writes that need to allocate an extra OutputBuffer instance to finish the message.
@@ -83,21 +90,26 @@ class OutputBuffer
 		static void Diagnostics(MessageType mtype);
 
 	private:
+		enum : size_t { SmallBuffers = 0, LargeBuffers, NumSizeClasses };	// the size classes
+
+		static bool Allocate(OutputBuffer *&buf, bool preferLarge);
+		size_t SizeClass() const { return (capacity == OUTPUT_BUFFER_SIZE) ? SmallBuffers : LargeBuffers; }
 
 		OutputBuffer *next;
 		OutputBuffer *last;
 
 		uint32_t whenQueued;
 
-		char data[OUTPUT_BUFFER_SIZE];
+		char * const data;
+		const size_t capacity;
 		size_t dataLength, bytesRead;
 
 		bool isReferenced;
 		size_t references;
 
-		static OutputBuffer * volatile freeOutputBuffers;		// Messages may also be sent by ISRs,
-		static volatile size_t usedOutputBuffers;				// so make these volatile.
-		static volatile size_t maxUsedOutputBuffers;
+		static OutputBuffer * volatile freeOutputBuffers[NumSizeClasses];	// Messages may also be sent by ISRs,
+		static volatile size_t usedOutputBuffers[NumSizeClasses];			// so make these volatile.
+		static volatile size_t maxUsedOutputBuffers[NumSizeClasses];
 };
 
 inline uint32_t OutputBuffer::GetAge() const
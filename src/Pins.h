@@ -42,4 +42,32 @@
 #define NONLINEAR_EXTRUSION		1		// for now this is always enabled
 #endif
 
+#ifndef SUPPORT_TIMED_STEP_PULSES
+#define SUPPORT_TIMED_STEP_PULSES	1	// 1 to end the extended step pulses of slow drivers using the RC compare interrupt of the step timer
+#endif
+
+#ifndef SUPPORT_NATIVE_ARCS
+# if SAM4E || SAME70
+#  define SUPPORT_NATIVE_ARCS		1	// 1 to execute G2/G3 arcs as single moves on Cartesian printers, needs a FPU because the step times are calculated using acosf
+# else
+#  define SUPPORT_NATIVE_ARCS		0
+# endif
+#endif
+
+#ifndef SUPPORT_S_CURVE
+# if SAM4E || SAME70
+#  define SUPPORT_S_CURVE			1	// 1 to support the jerk-limited S-curve acceleration profile, needs a FPU because the step times are found by Newton-Raphson iteration
+# else
+#  define SUPPORT_S_CURVE			0
+# endif
+#endif
+
+#ifndef SUPPORT_INPUT_SHAPING
+# if SAM4E || SAME70
+#  define SUPPORT_INPUT_SHAPING		1	// 1 to support input shaping using M594, needs a FPU because the step times are found by Newton-Raphson iteration
+# else
+#  define SUPPORT_INPUT_SHAPING		0
+# endif
+#endif
+
 #endif // PINS_H__
@@ -448,6 +448,10 @@ void Platform::Init()
 	ARRAY_INIT(accelerations, ACCELERATIONS);
 	ARRAY_INIT(driveStepsPerUnit, DRIVE_STEPS_PER_UNIT);
 	ARRAY_INIT(instantDvs, INSTANT_DVS);
+	junctionDeviation = DefaultJunctionDeviation;
+#if SUPPORT_S_CURVE
+	sCurveAcceleration = false;
+#endif
 	maxPrintingAcceleration = maxTravelAcceleration = 10000.0;
 
 	// Z PROBE
@@ -532,6 +536,10 @@ void Platform::Init()
 
 	slowDriverStepPulseClocks = 0;								// no extended driver timing configured yet
 	slowDrivers = 0;											// assume no drivers need extended step pulse timing
+#if SUPPORT_TIMED_STEP_PULSES
+	pendingSlowStepPins = 0;
+	lastSlowStepEdgeTime = 0;
+#endif
 
 	for (size_t extr = 0; extr < MaxExtruders; ++extr)
 	{
@@ -2561,6 +2569,10 @@ bool Platform::DiagnosticTest(GCodeBuffer& gb, StringRef& reply, int d)
 		}
 		break;
 
+	case (int)DiagnosticTestType::TimeJsonResponses:
+		reprap.TimeJsonResponses(reply);
+		break;
+
 #ifdef DUET_NG
 	case (int)DiagnosticTestType::PrintExpanderStatus:
 		reply.printf("Expander status %04X\n", DuetExpansion::DiagnosticRead());
@@ -4461,6 +4473,14 @@ void STEP_TC_HANDLER()
 #endif
 		SoftTimer::Interrupt();
 	}
+
+#if SUPPORT_TIMED_STEP_PULSES
+	if ((tcsr & TC_SR_CPCS) != 0)									// the end of slow driver step pulses uses RC compare
+	{
+		STEP_TC->TC_CHANNEL[STEP_TC_CHAN].TC_IDR = TC_IER_CPCS;		// disable the interrupt
+		reprap.GetPlatform().SlowStepPinsLowInterrupt();
+	}
+#endif
 }
 
 // Schedule an interrupt at the specified clock count, or return true if that time is imminent or has passed already.
@@ -4527,6 +4547,51 @@ void STEP_TC_HANDLER()
 	STEP_TC->TC_CHANNEL[STEP_TC_CHAN].TC_IDR = TC_IER_CPBS;
 }
 
+#if SUPPORT_TIMED_STEP_PULSES
+
+// Wait until the step pins of slow drivers have been low for long enough that we can step them again, returning the number of step clocks we waited.
+// This is called from the step ISR, so if the falling edge of the previous pulse is still pending we must generate it here, because the RC compare
+// interrupt can't pre-empt us. Normally both conditions have been satisfied already and we don't wait at all.
+uint32_t Platform::WaitForSlowDriversReady()
+{
+	const uint32_t startTime = GetInterruptClocks();
+	if (pendingSlowStepPins != 0)
+	{
+		STEP_TC->TC_CHANNEL[STEP_TC_CHAN].TC_IDR = TC_IER_CPCS;		// we will end the pulse ourselves
+		while (GetInterruptClocks() - lastSlowStepEdgeTime < slowDriverStepPulseClocks) {}
+		StepDriversLow();											// the step ISR always leaves the fast drivers low, so we can set all step pins low
+		pendingSlowStepPins = 0;
+		lastSlowStepEdgeTime = GetInterruptClocks();
+	}
+	while (GetInterruptClocks() - lastSlowStepEdgeTime < slowDriverStepPulseClocks) {}
+	return GetInterruptClocks() - startTime;
+}
+
+// Record that the step pins of some slow drivers have just been set high and schedule the interrupt that sets them low again.
+// The caller only uses this when the pulse width is at least DDA::minInterruptInterval, otherwise it generates the whole pulse itself.
+void Platform::ScheduleSlowStepPinsLow(uint32_t slowPins)
+{
+	lastSlowStepEdgeTime = GetInterruptClocks();
+	pendingSlowStepPins = slowPins;
+	STEP_TC->TC_CHANNEL[STEP_TC_CHAN].TC_RC = lastSlowStepEdgeTime + slowDriverStepPulseClocks;	// set up the compare register
+	STEP_TC->TC_CHANNEL[STEP_TC_CHAN].TC_IER = TC_IER_CPCS;			// enable the interrupt
+}
+
+// This is called by the step timer ISR when the step pulses of slow drivers are due to end.
+// We may occasionally get called prematurely, so check the time first.
+void Platform::SlowStepPinsLowInterrupt()
+{
+	if (pendingSlowStepPins != 0)
+	{
+		while (GetInterruptClocks() - lastSlowStepEdgeTime < slowDriverStepPulseClocks) {}
+		StepDriversLow();
+		pendingSlowStepPins = 0;
+		lastSlowStepEdgeTime = GetInterruptClocks();
+	}
+}
+
+#endif
+
 // Process a 1ms tick interrupt
 // This function must be kept fast so as not to disturb the stepper timing, so don't do any floating point maths in here.
 // This is what we need to do:
@@ -186,6 +186,8 @@ enum class DiagnosticTestType : int
 	PrintExpanderStatus = 101,		// print DueXn expander status
 #endif
 	TimeSquareRoot = 102,			// do a timing test on the square root function
+	TestSdThroughput = 104,			// measure how fast we can write and read a file on an SD card
+	TimeJsonResponses = 105,		// measure how fast we build the JSON responses
 
 	TestWatchdog = 1001,			// test that we get a watchdog reset if the tick interrupt stops
 	TestSpinLockup = 1002,			// test that we get a software reset if a Spin() function takes too long
@@ -438,6 +440,16 @@ public:
 	float ConfiguredInstantDv(size_t drive) const;
 	float ActualInstantDv(size_t drive) const;
 	void SetInstantDv(size_t drive, float value);
+	float GetJunctionDeviation() const
+		{ return junctionDeviation; }
+	void SetJunctionDeviation(float jd)
+		{ junctionDeviation = max<float>(jd, 0.0); }
+#if SUPPORT_S_CURVE
+	bool UseSCurveAcceleration() const
+		{ return sCurveAcceleration; }
+	void SetSCurveAcceleration(bool on)
+		{ sCurveAcceleration = on; }
+#endif
 	EndStopHit Stopped(size_t drive) const;
 	float AxisMaximum(size_t axis) const;
 	void SetAxisMaximum(size_t axis, float value, bool byProbing);
@@ -467,6 +479,13 @@ public:
 	uint32_t GetSlowDrivers() const { return slowDrivers; }
 	uint32_t GetSlowDriverClocks() const { return slowDriverStepPulseClocks; }
 
+#if SUPPORT_TIMED_STEP_PULSES
+	uint32_t GetPendingSlowStepPins() const { return pendingSlowStepPins; }
+	uint32_t WaitForSlowDriversReady() __attribute__ ((hot));		// wait until slow drivers may be stepped again, returning the number of clocks waited
+	void ScheduleSlowStepPinsLow(uint32_t slowPins) __attribute__ ((hot));	// record slow step pins just set high and schedule them to be set low
+	void SlowStepPinsLowInterrupt() __attribute__ ((hot));			// called from the step timer ISR to end the step pulse of slow drivers
+#endif
+
 #if NONLINEAR_EXTRUSION
 	bool GetExtrusionCoefficients(size_t extruder, float& a, float& b, float& limit) const;
 	void SetNonlinearExtrusion(size_t extruder, float a, float b, float limit);
@@ -722,6 +741,10 @@ private:
 	float maxTravelAcceleration;
 	float driveStepsPerUnit[DRIVES];
 	float instantDvs[DRIVES];
+	float junctionDeviation;							// if nonzero, XYZ cornering speeds are limited using this junction deviation instead of instantDvs
+#if SUPPORT_S_CURVE
+	bool sCurveAcceleration;							// true to use the jerk-limited S-curve acceleration profile instead of constant acceleration
+#endif
 	float pressureAdvance[MaxExtruders];
 #if NONLINEAR_EXTRUSION
 	float nonlinearExtrusionA[MaxExtruders], nonlinearExtrusionB[MaxExtruders], nonlinearExtrusionLimit[MaxExtruders];
@@ -736,6 +759,10 @@ private:
 	uint32_t driveDriverBits[2 * DRIVES];				// the bitmap of driver port bits for each axis or extruder, followed by the raw versions
 	uint32_t slowDriverStepPulseClocks;					// minimum high and low step pulse widths, in processor clocks
 	uint32_t slowDrivers;								// bitmap of driver port bits that need extended step pulse timing
+#if SUPPORT_TIMED_STEP_PULSES
+	volatile uint32_t pendingSlowStepPins;				// step pins of slow drivers that are high and waiting for the RC compare interrupt to set them low
+	uint32_t lastSlowStepEdgeTime;						// the step clock at which the step pins of slow drivers were last changed
+#endif
 	float idleCurrentFactor;
 
 #if HAS_SMART_DRIVERS
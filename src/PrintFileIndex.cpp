@@ -0,0 +1,205 @@
+/*
+ * PrintFileIndex.cpp
+ *
+ *  Created on: 16 Oct 2026
+ *      Author: agent
+ */
+
+#include "PrintFileIndex.h"
+
+#include "PrintMonitor.h"
+#include "Platform.h"
+
+// The index file starts with this header, followed by a PrintFileLayer record for each layer
+struct PrintFileIndex::Header
+{
+	uint32_t magic;							// identifies a complete index
+	uint32_t headerSize;					// the size of this struct, so that we don't use an index written by firmware with a different layout
+	uint32_t numLayers;
+	uint32_t totalMoves;
+	float totalPrintTime;					// print time in seconds excluding warm-up
+	GCodeFileInfo fileInfo;					// information about the G-code file, including the size and date that we use to check that the index is up to date
+};
+
+constexpr uint32_t IndexMagic = 0x31584449;								// "IDX1" as a little-endian word
+
+PrintFileIndex::PrintFileIndex(Platform& p)
+	: platform(p), indexDirectory(nullptr), recordFile(nullptr), numLayers(0), printTime(0.0), isLoaded(false)
+{
+}
+
+// Fill in the file information from a valid index. The file size and last modified time must already be in 'info'.
+bool PrintFileIndex::GetFileInfo(const char *directory, const char *fileName, GCodeFileInfo& info)
+{
+	String<FILENAME_LENGTH> name;
+	if (!MakeIndexFileName(fileName, name.GetRef()))
+	{
+		return false;
+	}
+
+	Header header;
+	FileStore * const f = OpenIndex(directory, name.c_str(), &info, header);
+	if (f == nullptr)
+	{
+		return false;
+	}
+	f->Close();
+	info = header.fileInfo;
+	info.printTime = header.totalPrintTime;
+	return true;
+}
+
+// Load the index of the file being printed if it has a valid one, given the size and date of the file in 'info'
+bool PrintFileIndex::Load(const char *directory, const char *fileName, const GCodeFileInfo& info)
+{
+	isLoaded = false;
+	if (!MakeIndexFileName(fileName, indexFileName.GetRef()))
+	{
+		return false;
+	}
+
+	Header header;
+	FileStore * const f = OpenIndex(directory, indexFileName.c_str(), &info, header);
+	if (f == nullptr)
+	{
+		return false;
+	}
+	f->Close();
+
+	indexDirectory = directory;
+	numLayers = header.numLayers;
+	printTime = header.totalPrintTime;
+	isLoaded = true;
+	return true;
+}
+
+// Get the details of a layer from the loaded index. Layers are numbered from 1.
+bool PrintFileIndex::GetLayer(unsigned int layer, PrintFileLayer& data)
+{
+	if (!isLoaded || layer == 0 || layer > numLayers)
+	{
+		return false;
+	}
+
+	Header header;
+	FileStore * const f = OpenIndex(indexDirectory, indexFileName.c_str(), nullptr, header);
+	if (f == nullptr)
+	{
+		isLoaded = false;
+		return false;
+	}
+
+	const bool ok = f->Seek(sizeof(Header) + (layer - 1) * sizeof(PrintFileLayer))
+					&& f->Read(reinterpret_cast<char*>(&data), sizeof(data)) == (int)sizeof(data);
+	f->Close();
+	return ok;
+}
+
+// Start recording the index of a file we are about to print from the beginning.
+// We write a header without the magic number now, and write the complete header when the print finishes.
+bool PrintFileIndex::StartRecording(const char *directory, const char *fileName)
+{
+	StopRecording(nullptr, 0.0, 0);
+	isLoaded = false;
+	if (!MakeIndexFileName(fileName, indexFileName.GetRef()))
+	{
+		return false;
+	}
+
+	recordFile = platform.OpenFile(directory, indexFileName.c_str(), OpenMode::write);
+	if (recordFile == nullptr)
+	{
+		return false;
+	}
+
+	indexDirectory = directory;
+	numLayers = 0;
+	Header header;
+	memset(&header, 0, sizeof(header));
+	if (!recordFile->Write(reinterpret_cast<const char*>(&header), sizeof(header)))
+	{
+		StopRecording(nullptr, 0.0, 0);
+		return false;
+	}
+	return true;
+}
+
+// Record the start of the next layer
+void PrintFileIndex::RecordLayer(const PrintFileLayer& data)
+{
+	if (recordFile != nullptr)
+	{
+		if (recordFile->Write(reinterpret_cast<const char*>(&data), sizeof(data)))
+		{
+			++numLayers;
+		}
+		else
+		{
+			StopRecording(nullptr, 0.0, 0);
+		}
+	}
+}
+
+// Finish recording the index. If 'info' is null then the print didn't complete or we don't know the file information, so we delete the index.
+void PrintFileIndex::StopRecording(const GCodeFileInfo *info, float totalPrintTime, uint32_t totalMoves)
+{
+	if (recordFile != nullptr)
+	{
+		bool ok = false;
+		if (info != nullptr && numLayers != 0 && recordFile->Flush() && recordFile->Seek(0))
+		{
+			Header header;
+			header.magic = IndexMagic;
+			header.headerSize = sizeof(Header);
+			header.numLayers = numLayers;
+			header.totalMoves = totalMoves;
+			header.totalPrintTime = totalPrintTime;
+			header.fileInfo = *info;
+			ok = recordFile->Write(reinterpret_cast<const char*>(&header), sizeof(header));
+		}
+		ok = recordFile->Close() && ok;
+		recordFile = nullptr;
+		if (!ok)
+		{
+			platform.GetMassStorage()->Delete(indexDirectory, indexFileName.c_str(), true);
+		}
+	}
+}
+
+// Make the name of the index file of a G-code file, returning false if it is too long.
+// The file name may include a path, in which case we put the '.' in front of the last part of it.
+/*static*/ bool PrintFileIndex::MakeIndexFileName(const char *fileName, const StringRef& indexName)
+{
+	const char * const lastSlash = strrchr(fileName, '/');
+	const int pathLength = (lastSlash == nullptr) ? 0 : lastSlash - fileName + 1;
+	return indexName.printf("%.*s.%s%s", pathLength, fileName, fileName + pathLength, IndexFileExtension) < (int)indexName.Length();
+}
+
+// Open an index file and read the header, returning the file if it is a complete index and, if 'info' is given, is for a file of that size and date
+FileStore *PrintFileIndex::OpenIndex(const char *directory, const char *indexName, const GCodeFileInfo *info, Header& header)
+{
+	if (!platform.GetMassStorage()->FileExists(directory, indexName))
+	{
+		return nullptr;
+	}
+
+	FileStore * const f = platform.OpenFile(directory, indexName, OpenMode::read);
+	if (f == nullptr)
+	{
+		return nullptr;
+	}
+
+	if (   f->Read(reinterpret_cast<char*>(&header), sizeof(header)) != (int)sizeof(header)
+		|| header.magic != IndexMagic
+		|| header.headerSize != sizeof(Header)
+		|| f->Length() != sizeof(Header) + header.numLayers * sizeof(PrintFileLayer)
+		|| (info != nullptr && (header.fileInfo.fileSize != info->fileSize || header.fileInfo.lastModifiedTime != info->lastModifiedTime))
+	   )
+	{
+		f->Close();
+		return nullptr;
+	}
+	return f;
+}
+
+// End
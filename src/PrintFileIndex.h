@@ -0,0 +1,67 @@
+/*
+ * PrintFileIndex.h
+ *
+ *  Created on: 16 Oct 2026
+ *      Author: agent
+ */
+
+#ifndef SRC_PRINTFILEINDEX_H_
+#define SRC_PRINTFILEINDEX_H_
+
+#include "RepRapFirmware.h"
+
+struct GCodeFileInfo;
+
+// Details of the start of a layer in a print file index
+struct PrintFileLayer
+{
+	FilePosition filePos;					// file position of the move that started the layer, which is the first one after the last extruding move of the previous layer
+	uint32_t movesDone;						// how many moves had been completed
+	float printTime;						// print time in seconds since warm-up finished
+	float filamentUsed;						// raw filament extruded in mm
+	float z;								// height of the layer
+};
+
+// Class to record and read an index of a G-code file. The index is stored alongside the file in a hidden file, named by putting '.' in front of
+// the file name and ".idx" after it, so that it doesn't appear in file lists. MassStorage deletes and renames it along with the G-code file.
+// We record the index while the file is printed and keep it if the print runs from the start of the file to the end. It holds the file information
+// followed by the details of the start of each layer. Then file information queries don't need to parse the file, time estimates can be based on
+// the layer times of the last print from the first layer on, and a print can be started from the beginning of any layer.
+// An index is only used if the size and date of the G-code file match those recorded in it.
+class PrintFileIndex
+{
+public:
+	PrintFileIndex(Platform& p);
+
+	bool GetFileInfo(const char *directory, const char *fileName, GCodeFileInfo& info);		// Fill in the file information from a valid index, given the file size and date
+	bool Load(const char *directory, const char *fileName, const GCodeFileInfo& info);		// Load the index of the file being printed if it has a valid one
+	void Unload() { isLoaded = false; }
+	bool IsLoaded() const { return isLoaded; }
+	unsigned int GetNumLayers() const { return numLayers; }
+	float GetPrintTime() const { return printTime; }
+	bool GetLayer(unsigned int layer, PrintFileLayer& data);								// Get the details of a layer from the loaded index, numbered from 1
+
+	bool StartRecording(const char *directory, const char *fileName);						// Start recording the index of the file being printed
+	bool IsRecording() const { return recordFile != nullptr; }
+	void RecordLayer(const PrintFileLayer& data);											// Record the start of the next layer
+	void StopRecording(const GCodeFileInfo *info, float totalPrintTime, uint32_t totalMoves);	// Finish recording, keeping the index only if 'info' is not null
+
+	static bool MakeIndexFileName(const char *fileName, const StringRef& indexName);		// Make the name of the index of a file, which may include a path
+
+private:
+	struct Header;
+
+	FileStore *OpenIndex(const char *directory, const char *indexName, const GCodeFileInfo *info, Header& header);
+
+	static constexpr const char *IndexFileExtension = ".idx";
+
+	Platform& platform;
+	const char *indexDirectory;
+	String<FILENAME_LENGTH> indexFileName;													// the index being recorded or loaded
+	FileStore *recordFile;
+	unsigned int numLayers;																	// the number of layers in the loaded index, or recorded so far
+	float printTime;																		// the print time recorded in the loaded index
+	bool isLoaded;
+};
+
+#endif /* SRC_PRINTFILEINDEX_H_ */
@@ -28,7 +28,7 @@ Licence: GPL
 PrintMonitor::PrintMonitor(Platform& p, GCodes& gc) : platform(p), gCodes(gc), isPrinting(false),
 	printStartTime(0), pauseStartTime(0), totalPauseTime(0), heatingUp(false), currentLayer(0), warmUpDuration(0.0),
 	firstLayerDuration(0.0), firstLayerFilament(0.0), firstLayerProgress(0.0), lastLayerChangeTime(0.0),
-	lastLayerFilament(0.0), lastLayerZ(0.0), numLayerSamples(0), layerEstimatedTimeLeft(0.0), parseState(notParsing),
+	lastLayerFilament(0.0), lastLayerZ(0.0), numLayerSamples(0), layerEstimatedTimeLeft(0.0), fileIndex(p), parseState(notParsing),
 	fileBeingParsed(nullptr), fileOverlapLength(0), printingFileParsed(false), accumulatedParseTime(0),
 	accumulatedReadTime(0), accumulatedSeekTime(0)
 {
@@ -109,6 +109,7 @@ void PrintMonitor::Spin()
 				// Yes - we're actually starting the print
 				WarmUpComplete();
 				currentLayer = 1;
+				LayerStarted();
 			}
 		}
 		// Print is in progress and filament is being extruded
@@ -136,6 +137,7 @@ void PrintMonitor::Spin()
 
 					lastLayerZ = liveCoordinates[Z_AXIS];
 					lastLayerChangeTime = GetPrintDuration();
+					LayerStarted();
 				}
 			}
 			// Check for following layer changes
@@ -149,6 +151,7 @@ void PrintMonitor::Spin()
 								? printingFileInfo.firstLayerHeight + (currentLayer - 1) * printingFileInfo.layerHeight
 									: liveCoordinates[Z_AXIS];
 				lastLayerChangeTime = GetPrintDuration();
+				LayerStarted();
 			}
 		}
 		lastUpdateTime = now;
@@ -177,6 +180,16 @@ void PrintMonitor::StartedPrint()
 {
 	isPrinting = true;
 	printStartTime = millis64();
+
+	// If we are printing the whole file for real, use its index if it has an up to date one, otherwise record one
+	fileIndex.Unload();
+	if (!gCodes.IsSimulating() && gCodes.FractionOfFilePrinted() == 0.0)
+	{
+		if (!printingFileParsed || !fileIndex.Load(platform.GetGCodeDir(), filenameBeingPrinted, printingFileInfo))
+		{
+			fileIndex.StartRecording(platform.GetGCodeDir(), filenameBeingPrinted);
+		}
+	}
 }
 
 // This is called as soon as the heaters are at temperature and the actual print has started
@@ -202,6 +215,48 @@ void PrintMonitor::FirstLayerComplete()
 	}
 }
 
+// This is called when we have started a layer. Record it in the index we are making, or use the index we have to estimate the time left.
+void PrintMonitor::LayerStarted()
+{
+	const float printTime = GetPrintDuration() - warmUpDuration;
+	PrintFileLayer layer;
+	if (fileIndex.IsRecording())
+	{
+		float liveCoordinates[DRIVES];
+		reprap.GetMove().LiveCoordinates(liveCoordinates, reprap.GetCurrentXAxes(), reprap.GetCurrentYAxes());
+		layer.filePos = gCodes.GetLayerStartFilePosition(reprap.GetMove().GetExecutingFilePosition());	// the move that started the layer, so that resuming from it does the Z change
+		layer.movesDone = reprap.GetMove().GetCompletedMoves();
+		layer.printTime = printTime;
+		layer.filamentUsed = gCodes.GetTotalRawExtrusion();
+		layer.z = liveCoordinates[Z_AXIS];
+		fileIndex.RecordLayer(layer);
+	}
+	else if (fileIndex.IsLoaded() && fileIndex.GetLayer(currentLayer, layer))
+	{
+		// Use the time the rest of the print took last time, scaled by how long this print has taken to get here compared to last time.
+		// EstimateTimeLeft subtracts the time since the last layer change, so add that.
+		const float speedRatio = (layer.printTime >= MIN_INDEXED_TIME_FOR_SCALING) ? printTime/layer.printTime : 1.0;
+		layerEstimatedTimeLeft = max<float>(fileIndex.GetPrintTime() - layer.printTime, 0.0) * speedRatio + (GetPrintDuration() - lastLayerChangeTime);
+	}
+}
+
+// Get the file position of the start of a layer of the file selected for printing from its index, returning false if it doesn't have an up to date index
+bool PrintMonitor::GetLayerFilePosition(unsigned int layer, FilePosition& pos)
+{
+	PrintFileLayer data;
+	if (   filenameBeingPrinted[0] != 0
+		&& printingFileParsed
+		&& (fileIndex.IsLoaded() || fileIndex.Load(platform.GetGCodeDir(), filenameBeingPrinted, printingFileInfo))
+		&& fileIndex.GetLayer(layer, data)
+		&& data.filePos != noFilePosition
+	   )
+	{
+		pos = data.filePos;
+		return true;
+	}
+	return false;
+}
+
 // This is called whenever a layer greater than 2 has been finished
 void PrintMonitor::LayerComplete()
 {
@@ -266,8 +321,12 @@ void PrintMonitor::LayerComplete()
 	}
 }
 
-void PrintMonitor::StoppedPrint()
+void PrintMonitor::StoppedPrint(bool normalCompletion)
 {
+	fileIndex.StopRecording((normalCompletion && printingFileParsed) ? &printingFileInfo : nullptr,
+								GetPrintDuration() - warmUpDuration, reprap.GetMove().GetCompletedMoves());
+	fileIndex.Unload();
+
 	isPrinting = heatingUp = printingFileParsed = false;
 	currentLayer = numLayerSamples = 0;
 	pauseStartTime = totalPauseTime = 0;
@@ -296,7 +355,8 @@ bool PrintMonitor::GetFileInfo(const char *directory, const char *fileName, GCod
 			return true;
 		}
 
-		// File has been opened, let's start now
+		// File has been opened, let's start now. We seek around near the end of the file to find the footer, so use a cluster map if we can get one.
+		(void)fileBeingParsed->EnableFastSeek();
 		SafeStrncpy(filenameBeingParsed, fileName, ARRAY_SIZE(filenameBeingParsed));
 		fileOverlapLength = 0;
 
@@ -307,6 +367,7 @@ bool PrintMonitor::GetFileInfo(const char *directory, const char *fileName, GCod
 		parsedFileInfo.firstLayerHeight = 0.0;
 		parsedFileInfo.objectHeight = 0.0;
 		parsedFileInfo.layerHeight = 0.0;
+		parsedFileInfo.printTime = 0.0;
 		parsedFileInfo.numFilaments = 0;
 		parsedFileInfo.generatedBy[0] = 0;
 		for(size_t extr = 0; extr < MaxExtruders; extr++)
@@ -314,6 +375,14 @@ bool PrintMonitor::GetFileInfo(const char *directory, const char *fileName, GCod
 			parsedFileInfo.filamentNeeded[extr] = 0.0;
 		}
 
+		// If the file has an up to date index then we don't need to parse it
+		if (fileIndex.GetFileInfo(directory, fileName, parsedFileInfo))
+		{
+			fileBeingParsed->Close();
+			info = parsedFileInfo;
+			return true;
+		}
+
 		// Record some debug values here
 		if (reprap.Debug(modulePrintMonitor))
 		{
@@ -631,6 +700,10 @@ bool PrintMonitor::GetFileInfoResponse(const char *filename, OutputBuffer *&resp
 			}
 			response->cat("],\"generatedBy\":");
 			response->EncodeString(info.generatedBy, ARRAY_SIZE(info.generatedBy), false);
+			if (info.printTime > 0.0)
+			{
+				response->catf(",\"printTime\":%d", (int)info.printTime);
+			}
 			response->cat("}");
 		}
 		else
@@ -21,6 +21,7 @@ Licence: GPL
 #define PRINTMONITOR_H
 
 #include "RepRapFirmware.h"
+#include "PrintFileIndex.h"
 
 const FilePosition GCODE_HEADER_SIZE = 20000uL;		// How many bytes to read from the header - I (DC) have a Kisslicer file with a layer height comment 14Kb from the start
 const FilePosition GCODE_FOOTER_SIZE = 400000uL;	// How many bytes to read from the footer
@@ -39,6 +40,7 @@ const size_t MAX_LAYER_SAMPLES = 5;					// Number of layer samples for end-time
 const float ESTIMATION_MIN_FILAMENT_USAGE = 0.01;	// Minimum per cent of filament to be printed before the filament-based estimation returns values
 const float ESTIMATION_MIN_FILE_USAGE = 0.001;		// Minimum per cent of the file to be processed before any file-based estimations are made
 const float FIRST_LAYER_SPEED_FACTOR = 0.25;		// First layer speed factor compared to other layers (only for layer-based estimation)
+const float MIN_INDEXED_TIME_FOR_SCALING = 60.0;	// Print time in seconds after which we scale the layer times from a print file index by how fast this print is going
 
 const uint32_t PRINTMONITOR_UPDATE_INTERVAL = 200;	// Update interval in milliseconds
 const uint32_t MAX_FILEINFO_PROCESS_TIME = 200;		// Maximum time to spend polling for file info in each call
@@ -61,6 +63,7 @@ struct GCodeFileInfo
 	float filamentNeeded[MaxExtruders];
 	unsigned int numFilaments;
 	float layerHeight;
+	float printTime;								// print time excluding warm-up from the index of the file, or zero if not known
 	char generatedBy[50];
 };
 
@@ -81,12 +84,13 @@ class PrintMonitor
 		bool IsPrinting() const;						// Is a file being printed?
 		void StartingPrint(const char *filename);		// Called to indicate a file will be printed (see M23)
 		void StartedPrint();							// Called whenever a new live print starts (see M24)
-		void StoppedPrint();							// Called whenever a file print has stopped
+		void StoppedPrint(bool normalCompletion);		// Called whenever a file print has stopped
 
 		// The following two methods need to be called until they return true - this may take a few runs
 		bool GetFileInfo(const char *directory, const char *fileName, GCodeFileInfo& info);
 		bool GetFileInfoResponse(const char *filename, OutputBuffer *&response);
 		void StopParsing(const char *filename);
+		bool GetLayerFilePosition(unsigned int layer, FilePosition& pos);	// Get the file position of a layer of the selected file from its index
 
 		// Return an estimate in seconds based on a specific estimation method
 		float EstimateTimeLeft(PrintEstimationMethod method) const;
@@ -111,6 +115,7 @@ class PrintMonitor
 		void WarmUpComplete();
 		void FirstLayerComplete();
 		void LayerComplete();
+		void LayerStarted();
 
 		bool isPrinting;
 		uint64_t printStartTime;
@@ -128,6 +133,9 @@ class PrintMonitor
 		float fileProgressPerLayer[MAX_LAYER_SAMPLES];
 		float layerEstimatedTimeLeft;
 
+		// Index of the file being printed, if it has one or we are recording one
+		PrintFileIndex fileIndex;
+
 		// We parse G-Code files in multiple stages. These variables hold the required information
 		volatile FileParseState parseState;
 		char filenameBeingParsed[FILENAME_LENGTH];
@@ -7,6 +7,7 @@
 #include "Platform.h"
 #include "Scanner.h"
 #include "PrintMonitor.h"
+#include "FileListGenerator.h"
 #include "Tools/Tool.h"
 #include "Tools/Filament.h"
 
@@ -57,8 +58,13 @@ extern "C" void hsmciIdle()
 RepRap::RepRap() : toolList(nullptr), currentTool(nullptr), lastWarningMillis(0), activeExtruders(0),
 	activeToolHeaters(0), ticksInSpinState(0), spinningModule(noModule), debug(0), stopped(false),
 	active(false), resetting(false), processingConfig(true), beepFrequency(0), beepDuration(0),
-	displayMessageBox(false), boxSeq(0)
+	displayMessageBox(false), boxSeq(0), sharedStatusResponseHits(0)
 {
+	for (SharedStatusResponse& r : sharedStatusResponses)
+	{
+		r.buffer = nullptr;
+	}
+
 	OutputBuffer::Init();
 	platform = new Platform();
 	network = new Network(*platform);
@@ -139,6 +145,9 @@ void RepRap::Init()
 #if HAS_HIGH_SPEED_SD
 	hsmci_set_idle_func(hsmciIdle);
 #endif
+	// The time taken to run the config file depends on the SD card and the network, so the step clock is different each time we get here
+	statusTracker.Init(Platform::GetInterruptClocks() ^ micros());
+
 	platform->MessageF(UsbMessage, "%s is up and running.\n", FIRMWARE_NAME);
 	fastLoop = UINT32_MAX;
 	slowLoop = 0;
@@ -179,6 +188,7 @@ void RepRap::Spin()
 
 	ticksInSpinState = 0;
 	spinningModule = moduleWebserver;
+	ReleaseSharedStatusResponses(false);
 
 	ticksInSpinState = 0;
 	spinningModule = moduleGcodes;
@@ -188,6 +198,22 @@ void RepRap::Spin()
 	spinningModule = moduleMove;
 	move->Spin();
 
+	// When printing a file of short moves, let the file channel queue several of them before we spin the other modules
+	const uint32_t burstStartClocks = Platform::GetInterruptClocks();
+	for (unsigned int burstLines = 0; ; ++burstLines)
+	{
+		ticksInSpinState = 0;
+		spinningModule = moduleGcodes;
+		if (!gCodes->SpinFileBurst(burstStartClocks, burstLines))
+		{
+			break;
+		}
+
+		ticksInSpinState = 0;
+		spinningModule = moduleMove;
+		move->Spin();
+	}
+
 	ticksInSpinState = 0;
 	spinningModule = moduleHeat;
 	heat->Spin();
@@ -266,6 +292,7 @@ void RepRap::Diagnostics(MessageType mtype)
 {
 	platform->Message(mtype, "=== Diagnostics ===\n");
 	OutputBuffer::Diagnostics(mtype);
+	platform->MessageF(mtype, "Shared status responses sent: %" PRIu32 "\n", sharedStatusResponseHits);
 	platform->Diagnostics(mtype);				// this includes a call to our Timing() function
 	move->Diagnostics(mtype);
 	heat->Diagnostics(mtype);
@@ -561,19 +588,37 @@ bool RepRap::SpinTimeoutImminent() const
 // Type 1 is the ordinary JSON status response.
 // Type 2 is the same except that static parameters are also included.
 // Type 3 is the same but instead of static parameters we report print estimation values.
-OutputBuffer *RepRap::GetStatusResponse(uint8_t type, ResponseSource source)
+// If 'since' is the "statusSeq" value from an earlier response then we leave out the sections that haven't changed since then.
+OutputBuffer *RepRap::GetStatusResponse(uint8_t type, ResponseSource source, uint32_t since)
 {
+	since = statusTracker.Start(since);
+
+	// If another HTTP client asked for the same response very recently, send it the same buffer chain
+	if (source == ResponseSource::HTTP)
+	{
+		OutputBuffer * const sharedResponse = GetSharedStatusResponse(type, since);
+		if (sharedResponse != nullptr)
+		{
+			return sharedResponse;
+		}
+	}
+
 	// Need something to write to...
 	OutputBuffer *response;
 	if (!OutputBuffer::Allocate(response))
 	{
-		// Should never happen
-		return nullptr;
+		// The responses we are holding on to may be using the buffers we need
+		ReleaseSharedStatusResponses(true);
+		if (!OutputBuffer::Allocate(response))
+		{
+			// Should never happen
+			return nullptr;
+		}
 	}
 
 	// Machine status
 	char ch = GetStatusCharacter();
-	response->printf("{\"status\":\"%c\",\"coords\":{", ch);
+	response->printf("{\"status\":\"%c\"", ch);
 
 	// Coordinates
 	const size_t numVisibleAxes = gCodes->GetVisibleAxes();
@@ -598,43 +643,60 @@ OutputBuffer *RepRap::GetStatusResponse(uint8_t type, ResponseSource source)
 			}
 		}
 
-		// Homed axes
-		response->cat("\"axesHomed\":");
-		ch = '[';
+		StatusFingerprint fp;
 		for (size_t axis = 0; axis < numVisibleAxes; ++axis)
 		{
-			response->catf("%c%d", ch, (gCodes->GetAxisIsHomed(axis)) ? 1 : 0);
-			ch = ',';
+			fp.Add((int)gCodes->GetAxisIsHomed(axis));
+			fp.Add(liveCoordinates[axis], 1000.0);
 		}
-
-		// Actual and theoretical extruder positions since power up, last G92 or last M23
-		response->catf("],\"extr\":");		// announce actual extruder positions
-		ch = '[';
 		for (size_t extruder = 0; extruder < GetExtrudersInUse(); extruder++)
 		{
-			response->catf("%c%.1f", ch, (double)liveCoordinates[gCodes->GetTotalAxes() + extruder]);
-			ch = ',';
+			fp.Add(liveCoordinates[gCodes->GetTotalAxes() + extruder], 10.0);
 		}
-		if (ch == '[')
+		if (statusTracker.Update(StatusSection::coords, fp, since))
 		{
-			response->cat(ch);
-		}
+			// Homed axes
+			response->cat(",\"coords\":{\"axesHomed\":");
+			ch = '[';
+			for (size_t axis = 0; axis < numVisibleAxes; ++axis)
+			{
+				response->cat(ch);
+				response->CatSigned((gCodes->GetAxisIsHomed(axis)) ? 1 : 0);
+				ch = ',';
+			}
 
-		// XYZ positions
-		// TODO ideally we would report "unknown" or similar for axis positions that are not known because we haven't homed them, but that requires changes to both DWC and PanelDue.
-		response->cat("],\"xyz\":");
-		ch = '[';
-		for (size_t axis = 0; axis < numVisibleAxes; axis++)
-		{
-			// Coordinates may be NaNs, for example when delta or SCARA homing fails. Replace any NaNs or infinities by 9999.9 to prevent JSON parsing errors.
-			const float coord = liveCoordinates[axis];
-			response->catf("%c%.3f", ch, (double)((std::isnan(coord) || std::isinf(coord)) ? 9999.9 : coord));
-			ch = ',';
+			// Actual and theoretical extruder positions since power up, last G92 or last M23
+			response->catf("],\"extr\":");		// announce actual extruder positions
+			ch = '[';
+			for (size_t extruder = 0; extruder < GetExtrudersInUse(); extruder++)
+			{
+				response->cat(ch);
+				response->CatFloat(liveCoordinates[gCodes->GetTotalAxes() + extruder], 1);
+				ch = ',';
+			}
+			if (ch == '[')
+			{
+				response->cat(ch);
+			}
+
+			// XYZ positions
+			// TODO ideally we would report "unknown" or similar for axis positions that are not known because we haven't homed them, but that requires changes to both DWC and PanelDue.
+			response->cat("],\"xyz\":");
+			ch = '[';
+			for (size_t axis = 0; axis < numVisibleAxes; axis++)
+			{
+				// Coordinates may be NaNs, for example when delta or SCARA homing fails. Replace any NaNs or infinities by 9999.9 to prevent JSON parsing errors.
+				const float coord = liveCoordinates[axis];
+				response->cat(ch);
+				response->CatFloat((std::isnan(coord) || std::isinf(coord)) ? 9999.9 : coord, 3);
+				ch = ',';
+			}
+			response->cat("]}");
 		}
 	}
 
 	// Current tool number
-	response->catf("]},\"currentTool\":%d", GetCurrentToolNumber());
+	response->catf(",\"currentTool\":%d", GetCurrentToolNumber());
 
 	// Output notifications
 	{
@@ -690,28 +752,45 @@ OutputBuffer *RepRap::GetStatusResponse(uint8_t type, ResponseSource source)
 
 	// Parameters
 	{
-		// ATX power
-		response->catf(",\"params\":{\"atxPower\":%d", platform->AtxPower() ? 1 : 0);
-
-		// Cooling fan value
-		response->cat(",\"fanPercent\":");
-		ch = '[';
-		for(size_t i = 0; i < NUM_FANS; i++)
+		StatusFingerprint fp;
+		fp.Add((int)platform->AtxPower());
+		for (size_t i = 0; i < NUM_FANS; i++)
 		{
-			response->catf("%c%.2f", ch, (double)(platform->GetFanValue(i) * 100.0));
-			ch = ',';
+			fp.Add(platform->GetFanValue(i), 10000.0);
 		}
-
-		// Speed and Extrusion factors
-		response->catf("],\"speedFactor\":%.2f,\"extrFactors\":", (double)(gCodes->GetSpeedFactor() * 100.0));
-		ch = '[';
+		fp.Add(gCodes->GetSpeedFactor(), 10000.0);
 		for (size_t extruder = 0; extruder < GetExtrudersInUse(); extruder++)
 		{
-			response->catf("%c%.2f", ch, (double)(gCodes->GetExtrusionFactor(extruder) * 100.0));
-			ch = ',';
+			fp.Add(gCodes->GetExtrusionFactor(extruder), 10000.0);
+		}
+		fp.Add(gCodes->GetBabyStepOffset(), 1000.0);
+		if (statusTracker.Update(StatusSection::params, fp, since))
+		{
+			// ATX power
+			response->catf(",\"params\":{\"atxPower\":%d", platform->AtxPower() ? 1 : 0);
+
+			// Cooling fan value
+			response->cat(",\"fanPercent\":");
+			ch = '[';
+			for(size_t i = 0; i < NUM_FANS; i++)
+			{
+				response->cat(ch);
+				response->CatFloat(platform->GetFanValue(i) * 100.0, 2);
+				ch = ',';
+			}
+
+			// Speed and Extrusion factors
+			response->catf("],\"speedFactor\":%.2f,\"extrFactors\":", (double)(gCodes->GetSpeedFactor() * 100.0));
+			ch = '[';
+			for (size_t extruder = 0; extruder < GetExtrudersInUse(); extruder++)
+			{
+				response->cat(ch);
+				response->CatFloat(gCodes->GetExtrusionFactor(extruder) * 100.0, 2);
+				ch = ',';
+			}
+			response->cat((ch == '[') ? "[]" : "]");
+			response->catf(",\"babystep\":%.03f}", (double)gCodes->GetBabyStepOffset());
 		}
-		response->cat((ch == '[') ? "[]" : "]");
-		response->catf(",\"babystep\":%.03f}", (double)gCodes->GetBabyStepOffset());
 	}
 
 	// G-code reply sequence for webserver (sequence number for AUX is handled later)
@@ -722,184 +801,237 @@ OutputBuffer *RepRap::GetStatusResponse(uint8_t type, ResponseSource source)
 
 	/* Sensors */
 	{
-		response->cat(",\"sensors\":{");
-
 		// Probe
 		const int v0 = platform->GetZProbeReading();
-		int v1, v2;
-		switch (platform->GetZProbeSecondaryValues(v1, v2))
+		int v1 = 0, v2 = 0;
+		const int numSecondaryValues = platform->GetZProbeSecondaryValues(v1, v2);
+		const unsigned int fanRpm = static_cast<unsigned int>(platform->GetFanRPM());
+
+		StatusFingerprint fp;
+		fp.Add(v0);
+		fp.Add(numSecondaryValues);
+		fp.Add(v1);
+		fp.Add(v2);
+		fp.Add((int)fanRpm);
+		if (statusTracker.Update(StatusSection::sensors, fp, since))
 		{
-			case 1:
-				response->catf("\"probeValue\":%d,\"probeSecondary\":[%d]", v0, v1);
-				break;
-			case 2:
-				response->catf("\"probeValue\":%d,\"probeSecondary\":[%d,%d]", v0, v1, v2);
-				break;
-			default:
-				response->catf("\"probeValue\":%d", v0);
-				break;
-		}
+			response->cat(",\"sensors\":{");
+			switch (numSecondaryValues)
+			{
+				case 1:
+					response->catf("\"probeValue\":%d,\"probeSecondary\":[%d]", v0, v1);
+					break;
+				case 2:
+					response->catf("\"probeValue\":%d,\"probeSecondary\":[%d,%d]", v0, v1, v2);
+					break;
+				default:
+					response->catf("\"probeValue\":%d", v0);
+					break;
+			}
 
-		// Fan RPM
-		response->catf(",\"fanRPM\":%d}", static_cast<unsigned int>(platform->GetFanRPM()));
+			// Fan RPM
+			response->catf(",\"fanRPM\":%u}", fanRpm);
+		}
 	}
 
 	/* Temperatures */
 	{
-		response->cat(",\"temps\":{");
-
-		/* Bed */
-		const int8_t bedHeater = (NumBedHeaters > 0) ? heat->GetBedHeater(0) : -1;
-		if (bedHeater != -1)
+		StatusFingerprint fp;
+		fp.Add((NumBedHeaters > 0) ? heat->GetBedHeater(0) : -1);
+		fp.Add((NumChamberHeaters > 0) ? heat->GetChamberHeater(0) : -1);
+		fp.Add((NumChamberHeaters > 1) ? heat->GetChamberHeater(1) : -1);
+		fp.Add((int)GetToolHeatersInUse());
+		for (size_t heater = 0; heater < Heaters; heater++)
 		{
-			response->catf("\"bed\":{\"current\":%.1f,\"active\":%.1f,\"state\":%d,\"heater\":%d},",
-				(double)heat->GetTemperature(bedHeater), (double)heat->GetActiveTemperature(bedHeater),
-					heat->GetStatus(bedHeater), bedHeater);
+			fp.Add(heat->GetTemperature(heater), 10.0);
+			fp.Add(heat->GetActiveTemperature(heater), 10.0);
+			fp.Add(heat->GetStandbyTemperature(heater), 10.0);
+			fp.Add((int)heat->GetStatus(heater));
 		}
-
-		/* Chamber */
-		const int8_t chamberHeater = (NumChamberHeaters > 0) ? heat->GetChamberHeater(0) : -1;
-		if (chamberHeater != -1)
+		for (const Tool *tool = toolList; tool != nullptr; tool = tool->Next())
 		{
-			response->catf("\"chamber\":{\"current\":%.1f,\"active\":%.1f,\"state\":%d,\"heater\":%d},",
-				(double)heat->GetTemperature(chamberHeater), (double)heat->GetActiveTemperature(chamberHeater),
-					heat->GetStatus(chamberHeater), chamberHeater);
+			for (size_t heater = 0; heater < tool->heaterCount; heater++)
+			{
+				fp.Add(tool->activeTemperatures[heater], 10.0);
+				fp.Add(tool->standbyTemperatures[heater], 10.0);
+			}
 		}
-
-		/* Cabinet */
-		const int8_t cabinetHeater = (NumChamberHeaters > 1) ? heat->GetChamberHeater(1) : -1;
-		if (cabinetHeater != -1)
+		for (size_t heater = FirstVirtualHeater; heater < FirstVirtualHeater + MaxVirtualHeaters; ++heater)
 		{
-			response->catf("\"cabinet\":{\"current\":%.1f,\"active\":%.1f,\"state\":%d,\"heater\":%d},",
-				(double)heat->GetTemperature(cabinetHeater), (double)heat->GetActiveTemperature(cabinetHeater),
-					heat->GetStatus(cabinetHeater), cabinetHeater);
+			const char * const nm = heat->GetHeaterName(heater);
+			if (nm != nullptr)
+			{
+				TemperatureError err;
+				fp.Add(nm);
+				fp.Add(heat->GetTemperature(heater, err), 10.0);
+			}
 		}
 
-		/* Heaters */
-
-		// Current temperatures
-		response->cat("\"current\":");
-		ch = '[';
-		for (size_t heater = 0; heater < Heaters; heater++)
+		if (statusTracker.Update(StatusSection::temps, fp, since))
 		{
-			response->catf("%c%.1f", ch, (double)heat->GetTemperature(heater));
-			ch = ',';
-		}
-		response->cat((ch == '[') ? "[]" : "]");
+			response->cat(",\"temps\":{");
 
-		// Current states
-		response->cat(",\"state\":");
-		ch = '[';
-		for (size_t heater = 0; heater < Heaters; heater++)
-		{
-			response->catf("%c%d", ch, heat->GetStatus(heater));
-			ch = ',';
-		}
-		response->cat((ch == '[') ? "[]" : "]");
+			/* Bed */
+			const int8_t bedHeater = (NumBedHeaters > 0) ? heat->GetBedHeater(0) : -1;
+			if (bedHeater != -1)
+			{
+				response->catf("\"bed\":{\"current\":%.1f,\"active\":%.1f,\"state\":%d,\"heater\":%d},",
+					(double)heat->GetTemperature(bedHeater), (double)heat->GetActiveTemperature(bedHeater),
+						heat->GetStatus(bedHeater), bedHeater);
+			}
 
-		/* Heads - NOTE: This field is subject to deprecation and will be removed in v1.20 */
-		response->cat(",\"heads\":{\"current\":");
+			/* Chamber */
+			const int8_t chamberHeater = (NumChamberHeaters > 0) ? heat->GetChamberHeater(0) : -1;
+			if (chamberHeater != -1)
+			{
+				response->catf("\"chamber\":{\"current\":%.1f,\"active\":%.1f,\"state\":%d,\"heater\":%d},",
+					(double)heat->GetTemperature(chamberHeater), (double)heat->GetActiveTemperature(chamberHeater),
+						heat->GetStatus(chamberHeater), chamberHeater);
+			}
 
-		// Current temperatures
-		ch = '[';
-		for (size_t heater = DefaultE0Heater; heater < GetToolHeatersInUse(); heater++)
-		{
-			response->catf("%c%.1f", ch, (double)heat->GetTemperature(heater));
-			ch = ',';
-		}
-		response->cat((ch == '[') ? "[]" : "]");
+			/* Cabinet */
+			const int8_t cabinetHeater = (NumChamberHeaters > 1) ? heat->GetChamberHeater(1) : -1;
+			if (cabinetHeater != -1)
+			{
+				response->catf("\"cabinet\":{\"current\":%.1f,\"active\":%.1f,\"state\":%d,\"heater\":%d},",
+					(double)heat->GetTemperature(cabinetHeater), (double)heat->GetActiveTemperature(cabinetHeater),
+						heat->GetStatus(cabinetHeater), cabinetHeater);
+			}
 
-		// Active temperatures
-		response->catf(",\"active\":");
-		ch = '[';
-		for (size_t heater = DefaultE0Heater; heater < GetToolHeatersInUse(); heater++)
-		{
-			response->catf("%c%.1f", ch, (double)heat->GetActiveTemperature(heater));
-			ch = ',';
-		}
-		response->cat((ch == '[') ? "[]" : "]");
+			/* Heaters */
 
-		// Standby temperatures
-		response->catf(",\"standby\":");
-		ch = '[';
-		for (size_t heater = DefaultE0Heater; heater < GetToolHeatersInUse(); heater++)
-		{
-			response->catf("%c%.1f", ch, (double)heat->GetStandbyTemperature(heater));
-			ch = ',';
-		}
-		response->cat((ch == '[') ? "[]" : "]");
+			// Current temperatures
+			response->cat("\"current\":");
+			ch = '[';
+			for (size_t heater = 0; heater < Heaters; heater++)
+			{
+				response->cat(ch);
+				response->CatFloat(heat->GetTemperature(heater), 1);
+				ch = ',';
+			}
+			response->cat((ch == '[') ? "[]" : "]");
 
-		// Heater statuses (0=off, 1=standby, 2=active, 3=fault)
-		response->cat(",\"state\":");
-		ch = '[';
-		for (size_t heater = DefaultE0Heater; heater < GetToolHeatersInUse(); heater++)
-		{
-			response->catf("%c%d", ch, static_cast<int>(heat->GetStatus(heater)));
-			ch = ',';
-		}
-		response->cat((ch == '[') ? "[]" : "]");
+			// Current states
+			response->cat(",\"state\":");
+			ch = '[';
+			for (size_t heater = 0; heater < Heaters; heater++)
+			{
+				response->cat(ch);
+				response->CatSigned(heat->GetStatus(heater));
+				ch = ',';
+			}
+			response->cat((ch == '[') ? "[]" : "]");
 
-		/* Tool temperatures */
-		response->cat("},\"tools\":{\"active\":[");
-		for (const Tool *tool = toolList; tool != nullptr; tool = tool->Next())
-		{
+			/* Heads - NOTE: This field is subject to deprecation and will be removed in v1.20 */
+			response->cat(",\"heads\":{\"current\":");
+
+			// Current temperatures
 			ch = '[';
-			for (size_t heater = 0; heater < tool->heaterCount; heater++)
+			for (size_t heater = DefaultE0Heater; heater < GetToolHeatersInUse(); heater++)
 			{
-				response->catf("%c%.1f", ch, (double)tool->activeTemperatures[heater]);
+				response->cat(ch);
+				response->CatFloat(heat->GetTemperature(heater), 1);
 				ch = ',';
 			}
 			response->cat((ch == '[') ? "[]" : "]");
 
-			if (tool->Next() != nullptr)
+			// Active temperatures
+			response->catf(",\"active\":");
+			ch = '[';
+			for (size_t heater = DefaultE0Heater; heater < GetToolHeatersInUse(); heater++)
 			{
-				response->cat(",");
+				response->cat(ch);
+				response->CatFloat(heat->GetActiveTemperature(heater), 1);
+				ch = ',';
 			}
-		}
+			response->cat((ch == '[') ? "[]" : "]");
 
-		response->cat("],\"standby\":[");
-		for (const Tool *tool = toolList; tool != nullptr; tool = tool->Next())
-		{
+			// Standby temperatures
+			response->catf(",\"standby\":");
 			ch = '[';
-			for (size_t heater = 0; heater < tool->heaterCount; heater++)
+			for (size_t heater = DefaultE0Heater; heater < GetToolHeatersInUse(); heater++)
 			{
-				response->catf("%c%.1f", ch, (double)tool->standbyTemperatures[heater]);
+				response->cat(ch);
+				response->CatFloat(heat->GetStandbyTemperature(heater), 1);
 				ch = ',';
 			}
 			response->cat((ch == '[') ? "[]" : "]");
 
-			if (tool->Next() != nullptr)
+			// Heater statuses (0=off, 1=standby, 2=active, 3=fault)
+			response->cat(",\"state\":");
+			ch = '[';
+			for (size_t heater = DefaultE0Heater; heater < GetToolHeatersInUse(); heater++)
 			{
-				response->cat(",");
+				response->cat(ch);
+				response->CatSigned(static_cast<int>(heat->GetStatus(heater)));
+				ch = ',';
 			}
-		}
+			response->cat((ch == '[') ? "[]" : "]");
 
-		// Named extra temperature sensors
-		response->cat("]},\"extra\":[");
-		bool first = true;
-		for (size_t heater = FirstVirtualHeater; heater < FirstVirtualHeater + MaxVirtualHeaters; ++heater)
-		{
-			const char * const nm = heat->GetHeaterName(heater);
-			if (nm != nullptr)
+			/* Tool temperatures */
+			response->cat("},\"tools\":{\"active\":[");
+			for (const Tool *tool = toolList; tool != nullptr; tool = tool->Next())
 			{
-				if (!first)
+				ch = '[';
+				for (size_t heater = 0; heater < tool->heaterCount; heater++)
 				{
-					response->cat(',');
+					response->cat(ch);
+					response->CatFloat(tool->activeTemperatures[heater], 1);
+					ch = ',';
+				}
+				response->cat((ch == '[') ? "[]" : "]");
+
+				if (tool->Next() != nullptr)
+				{
+					response->cat(",");
+				}
+			}
+
+			response->cat("],\"standby\":[");
+			for (const Tool *tool = toolList; tool != nullptr; tool = tool->Next())
+			{
+				ch = '[';
+				for (size_t heater = 0; heater < tool->heaterCount; heater++)
+				{
+					response->cat(ch);
+					response->CatFloat(tool->standbyTemperatures[heater], 1);
+					ch = ',';
+				}
+				response->cat((ch == '[') ? "[]" : "]");
+
+				if (tool->Next() != nullptr)
+				{
+					response->cat(",");
+				}
+			}
+
+			// Named extra temperature sensors
+			response->cat("]},\"extra\":[");
+			bool first = true;
+			for (size_t heater = FirstVirtualHeater; heater < FirstVirtualHeater + MaxVirtualHeaters; ++heater)
+			{
+				const char * const nm = heat->GetHeaterName(heater);
+				if (nm != nullptr)
+				{
+					if (!first)
+					{
+						response->cat(',');
+					}
+					first = false;
+					response->cat("{\"name\":");
+					response->EncodeString(nm, strlen(nm), false, true);
+					TemperatureError err;
+					const float t = heat->GetTemperature(heater, err);
+					response->catf(",\"temp\":%.1f}", (double)t);
 				}
-				first = false;
-				response->cat("{\"name\":");
-				response->EncodeString(nm, strlen(nm), false, true);
-				TemperatureError err;
-				const float t = heat->GetTemperature(heater, err);
-				response->catf(",\"temp\":%.1f}", (double)t);
 			}
-		}
 
-		response->cat("]}");
+			response->cat("]}");
+		}
 	}
 
-	// Time since last reset
-	response->catf(",\"time\":%.1f", (double)(millis64()/1000u));
+	// Time since last reset, and the sequence number that the client can pass back to get only the sections that have changed
+	response->catf(",\"time\":%.1f,\"statusSeq\":%" PRIu32, (double)(millis64()/1000u), statusTracker.GetSeq());
 
 #if SUPPORT_SCANNER
 	// Scanner
@@ -1077,51 +1209,70 @@ OutputBuffer *RepRap::GetStatusResponse(uint8_t type, ResponseSource source)
 	}
 	else if (type == 3)
 	{
-		// Current Layer
-		response->catf(",\"currentLayer\":%d", printMonitor->GetCurrentLayer());
-
-		// Current Layer Time
-		response->catf(",\"currentLayerTime\":%.1f", (double)(printMonitor->GetCurrentLayerTime()));
-
-		// Raw Extruder Positions
-		response->cat(",\"extrRaw\":");
-		ch = '[';
-		for (size_t extruder = 0; extruder < GetExtrudersInUse(); extruder++)		// loop through extruders
+		StatusFingerprint fp;
+		fp.Add((int)printMonitor->GetCurrentLayer());
+		fp.Add(printMonitor->GetCurrentLayerTime(), 10.0);
+		for (size_t extruder = 0; extruder < GetExtrudersInUse(); extruder++)
 		{
-			response->catf("%c%.1f", ch, (double)(gCodes->GetRawExtruderTotalByDrive(extruder)));
-			ch = ',';
+			fp.Add(gCodes->GetRawExtruderTotalByDrive(extruder), 10.0);
 		}
-		if (ch == '[')
+		fp.Add((printMonitor->IsPrinting()) ? gCodes->FractionOfFilePrinted() : 0.0, 1000.0);
+		fp.Add(printMonitor->GetFirstLayerDuration(), 10.0);
+		fp.Add(printMonitor->GetFirstLayerHeight(), 100.0);
+		fp.Add(printMonitor->GetPrintDuration(), 10.0);
+		fp.Add(printMonitor->GetWarmUpDuration(), 10.0);
+		fp.Add(printMonitor->EstimateTimeLeft(fileBased), 10.0);
+		fp.Add(printMonitor->EstimateTimeLeft(filamentBased), 10.0);
+		fp.Add(printMonitor->EstimateTimeLeft(layerBased), 10.0);
+		if (statusTracker.Update(StatusSection::printProgress, fp, since))
 		{
-			response->cat(ch);		// no extruders
-		}
+			// Current Layer
+			response->catf(",\"currentLayer\":%d", printMonitor->GetCurrentLayer());
+
+			// Current Layer Time
+			response->catf(",\"currentLayerTime\":%.1f", (double)(printMonitor->GetCurrentLayerTime()));
+
+			// Raw Extruder Positions
+			response->cat(",\"extrRaw\":");
+			ch = '[';
+			for (size_t extruder = 0; extruder < GetExtrudersInUse(); extruder++)		// loop through extruders
+			{
+				response->cat(ch);
+				response->CatFloat(gCodes->GetRawExtruderTotalByDrive(extruder), 1);
+				ch = ',';
+			}
+			if (ch == '[')
+			{
+				response->cat(ch);		// no extruders
+			}
 
-		// Fraction of file printed
-		response->catf("],\"fractionPrinted\":%.1f", (double)((printMonitor->IsPrinting()) ? (gCodes->FractionOfFilePrinted() * 100.0) : 0.0));
+			// Fraction of file printed
+			response->catf("],\"fractionPrinted\":%.1f", (double)((printMonitor->IsPrinting()) ? (gCodes->FractionOfFilePrinted() * 100.0) : 0.0));
 
-		// First Layer Duration
-		response->catf(",\"firstLayerDuration\":%.1f", (double)(printMonitor->GetFirstLayerDuration()));
+			// First Layer Duration
+			response->catf(",\"firstLayerDuration\":%.1f", (double)(printMonitor->GetFirstLayerDuration()));
 
-		// First Layer Height
-		// NB: This shouldn't be needed any more, but leave it here for the case that the file-based first-layer detection fails
-		response->catf(",\"firstLayerHeight\":%.2f", (double)(printMonitor->GetFirstLayerHeight()));
+			// First Layer Height
+			// NB: This shouldn't be needed any more, but leave it here for the case that the file-based first-layer detection fails
+			response->catf(",\"firstLayerHeight\":%.2f", (double)(printMonitor->GetFirstLayerHeight()));
 
-		// Print Duration
-		response->catf(",\"printDuration\":%.1f", (double)(printMonitor->GetPrintDuration()));
+			// Print Duration
+			response->catf(",\"printDuration\":%.1f", (double)(printMonitor->GetPrintDuration()));
 
-		// Warm-Up Time
-		response->catf(",\"warmUpDuration\":%.1f", (double)(printMonitor->GetWarmUpDuration()));
+			// Warm-Up Time
+			response->catf(",\"warmUpDuration\":%.1f", (double)(printMonitor->GetWarmUpDuration()));
 
-		/* Print Time Estimations */
-		{
-			// Based on file progress
-			response->catf(",\"timesLeft\":{\"file\":%.1f", (double)(printMonitor->EstimateTimeLeft(fileBased)));
+			/* Print Time Estimations */
+			{
+				// Based on file progress
+				response->catf(",\"timesLeft\":{\"file\":%.1f", (double)(printMonitor->EstimateTimeLeft(fileBased)));
 
-			// Based on filament usage
-			response->catf(",\"filament\":%.1f", (double)(printMonitor->EstimateTimeLeft(filamentBased)));
+				// Based on filament usage
+				response->catf(",\"filament\":%.1f", (double)(printMonitor->EstimateTimeLeft(filamentBased)));
 
-			// Based on layers
-			response->catf(",\"layer\":%.1f}", (double)(printMonitor->EstimateTimeLeft(layerBased)));
+				// Based on layers
+				response->catf(",\"layer\":%.1f}", (double)(printMonitor->EstimateTimeLeft(layerBased)));
+			}
 		}
 	}
 
@@ -1139,9 +1290,57 @@ OutputBuffer *RepRap::GetStatusResponse(uint8_t type, ResponseSource source)
 	}
 	response->cat("}");
 
+	if (source == ResponseSource::HTTP)
+	{
+		SetSharedStatusResponse(type, since, response);
+	}
 	return response;
 }
 
+// Return a status response that we built recently for another HTTP client, or nullptr if there isn't one
+OutputBuffer *RepRap::GetSharedStatusResponse(uint8_t type, uint32_t since)
+{
+	if (type >= 1 && type <= ARRAY_SIZE(sharedStatusResponses))
+	{
+		SharedStatusResponse& r = sharedStatusResponses[type - 1];
+		if (r.buffer != nullptr && r.since == since && millis() - r.whenCreated < SharedStatusResponseMillis)
+		{
+			r.buffer->IncreaseReferences(1);
+			++sharedStatusResponseHits;
+			return r.buffer;
+		}
+	}
+	return nullptr;
+}
+
+// Keep a reference to a status response that we have just built for an HTTP client, so that other clients can share it.
+// This works because the network code doesn't modify the responses it sends and keeps track of how much of each buffer it has sent itself.
+void RepRap::SetSharedStatusResponse(uint8_t type, uint32_t since, OutputBuffer *buf)
+{
+	if (type >= 1 && type <= ARRAY_SIZE(sharedStatusResponses))
+	{
+		SharedStatusResponse& r = sharedStatusResponses[type - 1];
+		OutputBuffer::ReleaseAll(r.buffer);
+		buf->IncreaseReferences(1);
+		r.buffer = buf;
+		r.whenCreated = millis();
+		r.since = since;
+	}
+}
+
+// Release the status responses that are too old to share, or all of them
+void RepRap::ReleaseSharedStatusResponses(bool all)
+{
+	for (SharedStatusResponse& r : sharedStatusResponses)
+	{
+		if (r.buffer != nullptr && (all || millis() - r.whenCreated >= SharedStatusResponseMillis))
+		{
+			OutputBuffer::ReleaseAll(r.buffer);
+			r.buffer = nullptr;
+		}
+	}
+}
+
 OutputBuffer *RepRap::GetConfigResponse()
 {
 	// We need some resources to return a valid config response...
@@ -1158,7 +1357,8 @@ OutputBuffer *RepRap::GetConfigResponse()
 	char ch = '[';
 	for (size_t axis = 0; axis < numAxes; axis++)
 	{
-		response->catf("%c%.2f", ch, (double)(platform->AxisMinimum(axis)));
+		response->cat(ch);
+		response->CatFloat(platform->AxisMinimum(axis), 2);
 		ch = ',';
 	}
 
@@ -1167,7 +1367,8 @@ OutputBuffer *RepRap::GetConfigResponse()
 	ch = '[';
 	for (size_t axis = 0; axis < numAxes; axis++)
 	{
-		response->catf("%c%.2f", ch, (double)(platform->AxisMaximum(axis)));
+		response->cat(ch);
+		response->CatFloat(platform->AxisMaximum(axis), 2);
 		ch = ',';
 	}
 
@@ -1176,7 +1377,8 @@ OutputBuffer *RepRap::GetConfigResponse()
 	ch = '[';
 	for (size_t drive = 0; drive < DRIVES; drive++)
 	{
-		response->catf("%c%.2f", ch, (double)(platform->Acceleration(drive)));
+		response->cat(ch);
+		response->CatFloat(platform->Acceleration(drive), 2);
 		ch = ',';
 	}
 
@@ -1185,7 +1387,8 @@ OutputBuffer *RepRap::GetConfigResponse()
 	ch = '[';
 	for (size_t drive = 0; drive < DRIVES; drive++)
 	{
-		response->catf("%c%.2f", ch, (double)(platform->GetMotorCurrent(drive, 906)));
+		response->cat(ch);
+		response->CatFloat(platform->GetMotorCurrent(drive, 906), 2);
 		ch = ',';
 	}
 
@@ -1219,7 +1422,8 @@ OutputBuffer *RepRap::GetConfigResponse()
 	ch = '[';
 	for (size_t drive = 0; drive < DRIVES; drive++)
 	{
-		response->catf("%c%.2f", ch, (double)(platform->ConfiguredInstantDv(drive)));
+		response->cat(ch);
+		response->CatFloat(platform->ConfiguredInstantDv(drive), 2);
 		ch = ',';
 	}
 
@@ -1228,7 +1432,8 @@ OutputBuffer *RepRap::GetConfigResponse()
 	ch = '[';
 	for (size_t drive = 0; drive < DRIVES; drive++)
 	{
-		response->catf("%c%.2f", ch, (double)(platform->MaxFeedrate(drive)));
+		response->cat(ch);
+		response->CatFloat(platform->MaxFeedrate(drive), 2);
 		ch = ',';
 	}
 
@@ -1272,7 +1477,8 @@ OutputBuffer *RepRap::GetLegacyStatusResponse(uint8_t type, int seq)
 	response->catf("[%.1f", (double)((bedHeater == -1) ? 0.0 : heat->GetTemperature(bedHeater)));
 	for (size_t heater = DefaultE0Heater; heater < GetToolHeatersInUse(); heater++)
 	{
-		response->catf("%c%.1f", ch, (double)(heat->GetTemperature(heater)));
+		response->cat(ch);
+		response->CatFloat(heat->GetTemperature(heater), 1);
 		ch = ',';
 	}
 	response->cat((ch == '[') ? "[]" : "]");
@@ -1316,7 +1522,8 @@ OutputBuffer *RepRap::GetLegacyStatusResponse(uint8_t type, int seq)
 	ch = '[';
 	for (size_t drive = 0; drive < numAxes; drive++)
 	{
-		response->catf("%c%.3f", ch, (double)liveCoordinates[drive]);
+		response->cat(ch);
+		response->CatFloat(liveCoordinates[drive], 3);
 		ch = ',';
 	}
 
@@ -1325,7 +1532,8 @@ OutputBuffer *RepRap::GetLegacyStatusResponse(uint8_t type, int seq)
 	ch = '[';
 	for (size_t i = 0; i < GetExtrudersInUse(); ++i)
 	{
-		response->catf("%c%.2f", ch, (double)(gCodes->GetExtrusionFactor(i) * 100.0));
+		response->cat(ch);
+		response->CatFloat(gCodes->GetExtrusionFactor(i) * 100.0, 2);
 		ch = ',';
 	}
 	response->cat((ch == '[') ? "[]" : "]");
@@ -1357,7 +1565,8 @@ OutputBuffer *RepRap::GetLegacyStatusResponse(uint8_t type, int seq)
 	ch = '[';
 	for (size_t i = 0; i < NUM_FANS; ++i)
 	{
-		response->catf("%c%.02f", ch, (double)(platform->GetFanValue(i) * 100.0));
+		response->cat(ch);
+		response->CatFloat(platform->GetFanValue(i) * 100.0, 2);
 		ch = ',';
 	}
 
@@ -1369,7 +1578,8 @@ OutputBuffer *RepRap::GetLegacyStatusResponse(uint8_t type, int seq)
 	ch = '[';
 	for (size_t axis = 0; axis < numAxes; ++axis)
 	{
-		response->catf("%c%d", ch, (gCodes->GetAxisIsHomed(axis)) ? 1 : 0);
+		response->cat(ch);
+		response->CatSigned((gCodes->GetAxisIsHomed(axis)) ? 1 : 0);
 		ch = ',';
 	}
 	response->cat(']');
@@ -1441,78 +1651,104 @@ OutputBuffer *RepRap::GetLegacyStatusResponse(uint8_t type, int seq)
 	return response;
 }
 
-// Get the list of files in the specified directory in JSON format.
-// If flagDirs is true then we prefix each directory with a * character.
-OutputBuffer *RepRap::GetFilesResponse(const char *dir, bool flagsDirs)
+// Return true if two output buffer chains hold the same text
+static bool SameText(const OutputBuffer *a, const OutputBuffer *b)
 {
-	// Need something to write to...
-	OutputBuffer *response;
-	if (!OutputBuffer::Allocate(response))
+	size_t aIndex = 0, bIndex = 0;
+	for (;;)
 	{
-		return nullptr;
+		while (a != nullptr && aIndex == a->DataLength())
+		{
+			a = a->Next();
+			aIndex = 0;
+		}
+		while (b != nullptr && bIndex == b->DataLength())
+		{
+			b = b->Next();
+			bIndex = 0;
+		}
+		if (a == nullptr || b == nullptr)
+		{
+			return a == b;
+		}
+		if (a->Data()[aIndex++] != b->Data()[bIndex++])
+		{
+			return false;
+		}
 	}
+}
 
-	response->copy("{\"dir\":");
-	response->EncodeString(dir, strlen(dir), false);
-	response->cat(",\"files\":[");
-	unsigned int err;
+// Measure how fast we build the JSON responses, and compare our number formatting with catf. Used by M122 P105.
+void RepRap::TimeJsonResponses(const StringRef& reply)
+{
+	static const char * const ResponseNames[] = { "status 1", "status 2", "status 3", "config", "legacy status" };
+
+	// Building a status response clears any pending message and beep and may clear an expired message box, so save them for the clients that are waiting for them
+	char savedMessage[MESSAGE_LENGTH + 1];
+	memcpy(savedMessage, message, sizeof(savedMessage));
+	const int savedBeepFrequency = beepFrequency, savedBeepDuration = beepDuration;
+	const bool savedDisplayMessageBox = displayMessageBox;
+
+	reply.copy("JSON responses:");
+	for (size_t i = 0; i < ARRAY_SIZE(ResponseNames); ++i)
+	{
+		const uint32_t startTime = micros();
+		OutputBuffer * const buf = (i < 3) ? GetStatusResponse(i + 1, ResponseSource::Generic, 0)
+									: (i == 3) ? GetConfigResponse()
+										: GetLegacyStatusResponse(3, -1);
+		const uint32_t timeTaken = max<uint32_t>(micros() - startTime, 1);
+		if (buf == nullptr)
+		{
+			reply.catf(" %s no buffer,", ResponseNames[i]);
+		}
+		else
+		{
+			const size_t length = buf->Length();
+			OutputBuffer::ReleaseAll(buf);
+			reply.catf(" %s %u bytes in %" PRIu32 "us (%.2f bytes/us),", ResponseNames[i], length, timeTaken, (double)length/timeTaken);
+		}
+	}
 
-	if (!platform->GetMassStorage()->CheckDriveMounted(dir))
+	memcpy(message, savedMessage, sizeof(message));
+	beepFrequency = savedBeepFrequency;
+	beepDuration = savedBeepDuration;
+	displayMessageBox = savedDisplayMessageBox;
+
+	// Format the same values using catf and using CatFloat
+	constexpr unsigned int NumValues = 100;
+	OutputBuffer *buf1, *buf2;
+	if (!OutputBuffer::Allocate(buf1))
 	{
-		err = 1;
+		return;
 	}
-	else
+	if (!OutputBuffer::Allocate(buf2))
 	{
-		err = 0;
-		FileInfo fileInfo;
-		bool firstFile = true;
-		bool gotFile = platform->GetMassStorage()->FindFirst(dir, fileInfo);	// TODO error handling here
-
-		size_t bytesLeft = OutputBuffer::GetBytesLeft(response);	// don't write more bytes than we can
-		char filename[FILENAME_LENGTH];
-		filename[0] = '*';
-		const char *fname;
-
-		while (gotFile)
-		{
-			if (fileInfo.fileName[0] != '.')						// ignore Mac resource files and Linux hidden files
-			{
-				// Get the long filename if possible
-				if (flagsDirs && fileInfo.isDirectory)
-				{
-					SafeStrncpy(filename + 1, fileInfo.fileName, ARRAY_SIZE(fileInfo.fileName) - 1);
-					fname = filename;
-				}
-				else
-				{
-					fname = fileInfo.fileName;
-				}
-
-				// Make sure we can end this response properly
-				if (bytesLeft < strlen(fname) * 2 + 4)
-				{
-					// No more space available - stop here
-					break;
-				}
-
-				// Write separator and filename
-				if (!firstFile)
-				{
-					bytesLeft -= response->cat(',');
-				}
-				bytesLeft -= response->EncodeString(fname, FILENAME_LENGTH, false);
+		OutputBuffer::Release(buf1);
+		return;
+	}
 
-				firstFile = false;
-			}
-			gotFile = platform->GetMassStorage()->FindNext(fileInfo);	// TODO error handling here
-		}
+	uint32_t printfTime = 0, fastTime = 0;
+	for (unsigned int i = 0; i < NumValues; ++i)
+	{
+		const float f = (float)((i * 7919) % 20000)/7.0 - 1000.0;
+		const uint32_t startTime = micros();
+		buf1->catf(",%.1f", (double)f);
+		const uint32_t midTime = micros();
+		buf2->cat(',');
+		buf2->CatFloat(f, 1);
+		fastTime += micros() - midTime;
+		printfTime += midTime - startTime;
 	}
-	response->catf("],\"err\":%u}", err);
-	return response;
+	const bool same = SameText(buf1, buf2);
+	OutputBuffer::ReleaseAll(buf1);
+	OutputBuffer::ReleaseAll(buf2);
+	reply.catf(" %u numbers with catf %" PRIu32 "us, with CatFloat %" PRIu32 "us, results %s", NumValues, printfTime, fastTime, (same) ? "match" : "DIFFER");
 }
 
-// Get a JSON-style filelist including file types and sizes
-OutputBuffer *RepRap::GetFilelistResponse(const char *dir)
+// Get the list of files in the specified directory in JSON format, starting at entry number 'startAt'.
+// If flagDirs is true then we prefix each directory with a * character.
+// If the list doesn't fit in the output buffers then we stop early and set "next" to the number of the first entry we didn't send, so that the client can ask for the rest.
+OutputBuffer *RepRap::GetFilesResponse(const char *dir, unsigned int startAt, bool flagsDirs)
 {
 	// Need something to write to...
 	OutputBuffer *response;
@@ -1521,69 +1757,26 @@ OutputBuffer *RepRap::GetFilelistResponse(const char *dir)
 		return nullptr;
 	}
 
-	// If the requested volume is not mounted, report an error
-	if (!platform->GetMassStorage()->CheckDriveMounted(dir))
-	{
-		response->copy("{\"err\":1}");
-		return response;
-	}
-
-	// Check if the directory exists
-	if (!platform->GetMassStorage()->DirectoryExists(dir))
-	{
-		response->copy("{\"err\":2}");
-		return response;
-	}
-
-	response->copy("{\"dir\":");
-	response->EncodeString(dir, strlen(dir), false);
-	response->cat(",\"files\":[");
-
-	FileInfo fileInfo;
-	bool firstFile = true;
-	bool gotFile = platform->GetMassStorage()->FindFirst(dir, fileInfo);
-	size_t bytesLeft = OutputBuffer::GetBytesLeft(response);	// don't write more bytes than we can
+	FileListGenerator generator;
+	generator.Start(dir, startAt, (flagsDirs) ? FileListGenerator::ListType::filesFlagDirs : FileListGenerator::ListType::files);
+	generator.GetResponse(response);
+	return response;
+}
 
-	while (gotFile)
+// Get a JSON-style filelist including file types and sizes, starting at entry number 'startAt'.
+// If the list doesn't fit in the output buffers then we stop early and set "next" to the number of the first entry we didn't send.
+OutputBuffer *RepRap::GetFilelistResponse(const char *dir, unsigned int startAt)
+{
+	// Need something to write to...
+	OutputBuffer *response;
+	if (!OutputBuffer::Allocate(response))
 	{
-		if (fileInfo.fileName[0] != '.')			// ignore Mac resource files and Linux hidden files
-		{
-			// Make sure we can end this response properly
-			if (bytesLeft < strlen(fileInfo.fileName) + 70)
-			{
-				// No more space available - stop here
-				break;
-			}
-
-			// Write delimiter
-			if (!firstFile)
-			{
-				bytesLeft -= response->cat(',');
-			}
-			firstFile = false;
-
-			// Write another file entry
-			bytesLeft -= response->catf("{\"type\":\"%c\",\"name\":", fileInfo.isDirectory ? 'd' : 'f');
-			bytesLeft -= response->EncodeString(fileInfo.fileName, FILENAME_LENGTH, false);
-			bytesLeft -= response->catf(",\"size\":%" PRIu32, fileInfo.size);
-
-			const struct tm * const timeInfo = gmtime(&fileInfo.lastModified);
-			if (timeInfo->tm_year <= /*19*/80)
-			{
-				// Don't send the last modified date if it is invalid
-				bytesLeft -= response->cat('}');
-			}
-			else
-			{
-				bytesLeft -= response->catf(",\"date\":\"%04u-%02u-%02uT%02u:%02u:%02u\"}",
-						timeInfo->tm_year + 1900, timeInfo->tm_mon + 1, timeInfo->tm_mday,
-						timeInfo->tm_hour, timeInfo->tm_min, timeInfo->tm_sec);
-			}
-		}
-		gotFile = platform->GetMassStorage()->FindNext(fileInfo);
+		return nullptr;
 	}
-	response->cat("]}");
 
+	FileListGenerator generator;
+	generator.Start(dir, startAt, FileListGenerator::ListType::filelist);
+	generator.GetResponse(response);
 	return response;
 }
 
@@ -23,6 +23,7 @@ Licence: GPL
 
 #include "RepRapFirmware.h"
 #include "MessageType.h"
+#include "StatusChangeTracker.h"
 
 enum class ResponseSource
 {
@@ -94,11 +95,12 @@ public:
 	uint16_t GetExtrudersInUse() const;
 	uint16_t GetToolHeatersInUse() const;
 
-	OutputBuffer *GetStatusResponse(uint8_t type, ResponseSource source);
+	OutputBuffer *GetStatusResponse(uint8_t type, ResponseSource source, uint32_t since);
 	OutputBuffer *GetConfigResponse();
 	OutputBuffer *GetLegacyStatusResponse(uint8_t type, int seq);
-	OutputBuffer *GetFilesResponse(const char* dir, bool flagsDirs);
-	OutputBuffer *GetFilelistResponse(const char* dir);
+	OutputBuffer *GetFilesResponse(const char* dir, unsigned int startAt, bool flagsDirs);
+	OutputBuffer *GetFilelistResponse(const char* dir, unsigned int startAt);
+	void TimeJsonResponses(const StringRef& reply);				// Measure how fast we build the JSON responses
 
 	void Beep(int freq, int ms);
 	void SetMessage(const char *msg);
@@ -117,6 +119,9 @@ private:
 	static void EncodeString(StringRef& response, const char* src, size_t spaceToLeave, bool allowControlChars = false, char prefix = 0);
 
 	char GetStatusCharacter() const;
+	OutputBuffer *GetSharedStatusResponse(uint8_t type, uint32_t since);
+	void SetSharedStatusResponse(uint8_t type, uint32_t since, OutputBuffer *buf);
+	void ReleaseSharedStatusResponses(bool all);
 
 	static constexpr uint32_t MaxTicksInSpinState = 20000;	// timeout before we reset the processor
 	static constexpr uint32_t HighTicksInSpinState = 16000;	// how long before we warn that timeout is approaching
@@ -165,6 +170,18 @@ private:
 	uint32_t boxSeq;
 	uint32_t boxTimer, boxTimeout;
 	AxesBitmap boxControls;
+
+	StatusChangeTracker statusTracker;			// when each section of the status response last changed
+
+	// Status responses that we have sent to HTTP clients recently, so that several clients polling at the same time can share them
+	struct SharedStatusResponse
+	{
+		OutputBuffer *buffer;					// we hold one reference to this
+		uint32_t whenCreated;
+		uint32_t since;							// the sequence number that the response was built for
+	};
+	SharedStatusResponse sharedStatusResponses[3];	// one for each status response type
+	uint32_t sharedStatusResponseHits;
 };
 
 inline Platform& RepRap::GetPlatform() const { return *platform; }
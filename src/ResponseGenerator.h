@@ -0,0 +1,25 @@
+/*
+ * ResponseGenerator.h
+ *
+ *  Created on: 16 Oct 2026
+ *      Author: agent
+ */
+
+#ifndef SRC_RESPONSEGENERATOR_H_
+#define SRC_RESPONSEGENERATOR_H_
+
+#include "RepRapFirmware.h"
+
+// Interface for responses that can be produced a piece at a time as the client takes them, instead of being built in full before we send them.
+// The network responders ask for the next piece when they have sent the previous one, so the memory used doesn't depend on the size of the response.
+class ResponseGenerator
+{
+public:
+	// Append the next part of the response to 'buf', writing not much more than 'maxBytes'. Return true if there is more to come.
+	virtual bool GetNextChunk(OutputBuffer *buf, size_t maxBytes) = 0;
+
+protected:
+	~ResponseGenerator() { }
+};
+
+#endif /* SRC_RESPONSEGENERATOR_H_ */
@@ -0,0 +1,84 @@
+/*
+ * StatusChangeTracker.cpp
+ *
+ *  Created on: 16 Oct 2026
+ *      Author: agent
+ */
+
+#include "StatusChangeTracker.h"
+
+#include <cmath>
+
+// Add a word to the fingerprint using the FNV-1a hash, which is fast and good enough to spot changes
+void StatusFingerprint::Add(uint32_t v)
+{
+	for (unsigned int i = 0; i < 4; ++i)
+	{
+		hash = (hash ^ (v & 0xFF)) * 16777619u;
+		v >>= 8;
+	}
+}
+
+// Add a float reported to a precision of 1/scale
+void StatusFingerprint::Add(float v, float scale)
+{
+	Add((std::isnan(v) || std::isinf(v)) ? 0x7FFFFFFFu : (uint32_t)lrintf(v * scale));
+}
+
+void StatusFingerprint::Add(const char *s)
+{
+	while (*s != 0)
+	{
+		hash = (hash ^ (uint8_t)*s++) * 16777619u;
+	}
+	hash = hash * 16777619u;								// so that adjacent strings can't run together
+}
+
+StatusChangeTracker::StatusChangeTracker() : seq(1)
+{
+	for (size_t i = 0; i < (size_t)StatusSection::numSections; ++i)
+	{
+		fingerprints[i] = 0;
+		changeSeqs[i] = 1;
+	}
+}
+
+// Choose the epoch from a value that is different each time we start up.
+// When the change count overflows into the epoch bits we just move on to another epoch, which makes clients fetch the whole status once.
+void StatusChangeTracker::Init(uint32_t seed)
+{
+	StatusFingerprint fp;
+	fp.Add(seed);														// spread the variation in the seed over all the epoch bits
+	uint32_t epoch = fp.Get() >> EpochShift;
+	if (epoch == 0)
+	{
+		epoch = 1;														// so that a client that uses since=0 before it has a sequence number can't match
+	}
+	seq = (epoch << EpochShift) | 1;
+	for (size_t i = 0; i < (size_t)StatusSection::numSections; ++i)
+	{
+		changeSeqs[i] = seq;
+	}
+}
+
+// Return the sequence number to compare section changes with, or 0 if the client needs everything.
+// A number from another epoch, e.g. one the client got before we were reset, is treated as unknown.
+uint32_t StatusChangeTracker::Start(uint32_t since) const
+{
+	return ((since >> EpochShift) != (seq >> EpochShift) || since > seq) ? 0 : since;
+}
+
+// Record the fingerprint of a section and return true if it must be sent to a client that has the status as of sequence number 'since'.
+// 'since' must have been returned by Start.
+bool StatusChangeTracker::Update(StatusSection section, const StatusFingerprint& fp, uint32_t since)
+{
+	const size_t i = (size_t)section;
+	if (fp.Get() != fingerprints[i])
+	{
+		fingerprints[i] = fp.Get();
+		changeSeqs[i] = ++seq;
+	}
+	return since == 0 || changeSeqs[i] > since;
+}
+
+// End
@@ -0,0 +1,64 @@
+/*
+ * StatusChangeTracker.h
+ *
+ *  Created on: 16 Oct 2026
+ *      Author: agent
+ */
+
+#ifndef SRC_STATUSCHANGETRACKER_H_
+#define SRC_STATUSCHANGETRACKER_H_
+
+#include "RepRapFirmware.h"
+
+// The parts of the JSON status response that we leave out if the client says it already has them
+enum class StatusSection : uint8_t
+{
+	coords = 0,				// homed axes, extruder and axis positions
+	params,					// ATX power, fans, speed and extrusion factors, babystepping
+	sensors,				// Z probe and fan RPM
+	temps,					// heater, tool and extra sensor temperatures
+	printProgress,			// the print monitor values in the type 3 response
+	numSections
+};
+
+// Class to build a fingerprint of the values reported in a section of the status response, without formatting them.
+// Float values are rounded to the precision that we report them at, so that changes that the client wouldn't see don't make the section dirty.
+class StatusFingerprint
+{
+public:
+	StatusFingerprint() : hash(2166136261u) { }
+
+	void Add(uint32_t v);
+	void Add(int v) { Add((uint32_t)v); }
+	void Add(float v, float scale);			// add a float reported to a precision of 1/scale
+	void Add(const char *s);
+
+	uint32_t Get() const { return hash; }
+
+private:
+	uint32_t hash;
+};
+
+// Class to keep track of when each section of the status response last changed.
+// Each response carries the current sequence number. A client that passes that number back in its next request only gets the sections
+// whose values have changed since, plus the fields that are always sent. We only look for changes when we build a response.
+// The top bits of the sequence number hold an epoch that is chosen at random when we start up, so that a number from before a reset is not mistaken for a current one.
+class StatusChangeTracker
+{
+public:
+	StatusChangeTracker();
+
+	void Init(uint32_t seed);															// Choose the epoch for this boot
+	uint32_t Start(uint32_t since) const;												// Return the sequence number to compare with, 0 if the client needs everything
+	bool Update(StatusSection section, const StatusFingerprint& fp, uint32_t since);	// Record the fingerprint and return true if the section must be sent
+	uint32_t GetSeq() const { return seq; }
+
+private:
+	static constexpr unsigned int EpochShift = 16;						// the low bits count changes, the high bits hold the epoch
+
+	uint32_t seq;														// the sequence number of the last change to any section
+	uint32_t fingerprints[(size_t)StatusSection::numSections];
+	uint32_t changeSeqs[(size_t)StatusSection::numSections];			// the sequence number of the last change to each section
+};
+
+#endif /* SRC_STATUSCHANGETRACKER_H_ */
@@ -0,0 +1,160 @@
+/*
+ * DirectoryCache.cpp
+ *
+ *  Created on: 16 Oct 2026
+ *      Author: agent
+ */
+
+#include "DirectoryCache.h"
+#include "MassStorage.h"
+
+// Each entry in the cache is this header followed by the file name without a null terminator, padded to a multiple of 4 bytes.
+// We copy the header in and out because entries are only 4-byte aligned.
+struct DirectoryCache::EntryHeader
+{
+	time_t lastModified;
+	uint32_t size;
+	uint8_t isDirectory;
+	uint8_t nameLength;
+};
+
+DirectoryCache::DirectoryCache(MassStorage& ms)
+	: massStorage(ms), firstIndex(0), numEntries(0), nextIndex(0), nextOffset(0), bytesUsed(0), scanIndex(0), scanSequence(0),
+	  isValid(false), scanValid(false), isComplete(false)
+{
+}
+
+// Get entry number 'startAt' of a directory, returning false if there is no such entry. Entries are numbered from 0.
+bool DirectoryCache::FindFirst(const char *dir, unsigned int startAt, FileInfo& fileInfo)
+{
+	String<FILENAME_LENGTH> dirName;
+	dirName.GetRef().copy(dir);
+	const size_t len = dirName.strlen();
+	if (len != 0 && dirName[len - 1] == '/')
+	{
+		dirName[len - 1] = 0;
+	}
+
+	if (!isValid || !StringEquals(dirName.c_str(), directory.c_str()))
+	{
+		directory.GetRef().copy(dirName.c_str());
+		isValid = scanValid = false;
+	}
+
+	if (!isValid || startAt < firstIndex || (startAt >= firstIndex + numEntries && !isComplete))
+	{
+		if (!Fill(startAt))
+		{
+			return false;
+		}
+	}
+
+	// Skip to the requested entry
+	nextIndex = firstIndex;
+	nextOffset = 0;
+	while (nextIndex < startAt && nextIndex < firstIndex + numEntries)
+	{
+		EntryHeader header;
+		memcpy(&header, reinterpret_cast<const char*>(data) + nextOffset, sizeof(header));
+		nextOffset += (sizeof(EntryHeader) + header.nameLength + 3) & ~3;
+		++nextIndex;
+	}
+	return FindNext(fileInfo);
+}
+
+// Get the next entry, returning false if there are no more
+bool DirectoryCache::FindNext(FileInfo& fileInfo)
+{
+	if (!isValid)
+	{
+		return false;
+	}
+	if (nextIndex >= firstIndex + numEntries)
+	{
+		if (isComplete || !Fill(nextIndex))
+		{
+			return false;
+		}
+	}
+	return GetEntry(fileInfo);
+}
+
+// Copy out the next entry and advance past it. It must be in the cache.
+bool DirectoryCache::GetEntry(FileInfo& fileInfo)
+{
+	const char * const p = reinterpret_cast<const char*>(data) + nextOffset;
+	EntryHeader header;
+	memcpy(&header, p, sizeof(header));
+	memcpy(fileInfo.fileName, p + sizeof(header), header.nameLength);
+	fileInfo.fileName[header.nameLength] = 0;
+	fileInfo.isDirectory = (header.isDirectory != 0);
+	fileInfo.size = header.size;
+	fileInfo.lastModified = header.lastModified;
+
+	nextOffset += (sizeof(EntryHeader) + header.nameLength + 3) & ~3;
+	++nextIndex;
+	return true;
+}
+
+// Read the directory from the card, keeping as many entries as will fit starting at entry 'startAt'.
+// Return true if there are any entries from that one on. On return, nextIndex and nextOffset refer to the first entry.
+bool DirectoryCache::Fill(unsigned int startAt)
+{
+	firstIndex = nextIndex = startAt;
+	numEntries = 0;
+	nextOffset = bytesUsed = 0;
+	isComplete = false;
+	isValid = true;
+
+	// If we stopped reading this directory at or before the entry we want and nothing else has used FindFirst since, carry on from there.
+	// Otherwise start again at the beginning. This keeps walking through a big directory a cache-full at a time linear in the size of the directory.
+	FileInfo fileInfo;
+	bool gotFile;
+	unsigned int index;
+	if (scanValid && scanIndex <= startAt && scanSequence == massStorage.GetFindSequence())
+	{
+		index = scanIndex;
+		gotFile = massStorage.FindNext(fileInfo);
+	}
+	else
+	{
+		index = 0;
+		gotFile = massStorage.FindFirst(directory.c_str(), fileInfo);
+		scanSequence = massStorage.GetFindSequence();
+	}
+	for (; gotFile && index < startAt; ++index)
+	{
+		gotFile = massStorage.FindNext(fileInfo);
+	}
+	scanValid = true;
+
+	// We stop when there may not be room for another entry, so that we never read an entry that we can't keep
+	constexpr size_t MaxEntrySize = (sizeof(EntryHeader) + FILENAME_LENGTH - 1 + 3) & ~3;	// FileInfo names are at most FILENAME_LENGTH - 1 characters
+	while (gotFile)
+	{
+		EntryHeader header;
+		header.lastModified = fileInfo.lastModified;
+		header.size = fileInfo.size;
+		header.isDirectory = fileInfo.isDirectory;
+		header.nameLength = (uint8_t)strnlen(fileInfo.fileName, ARRAY_SIZE(fileInfo.fileName) - 1);
+		const size_t entrySize = (sizeof(EntryHeader) + header.nameLength + 3) & ~3;
+
+		char * const p = reinterpret_cast<char*>(data) + bytesUsed;
+		memcpy(p, &header, sizeof(header));
+		memcpy(p + sizeof(header), fileInfo.fileName, header.nameLength);
+		bytesUsed += entrySize;
+		++numEntries;
+		scanIndex = startAt + numEntries;
+		if (sizeof(data) - bytesUsed < MaxEntrySize)
+		{
+			return true;										// the cache is full, so we will read the rest of the directory when it is asked for
+		}
+		gotFile = massStorage.FindNext(fileInfo);
+	}
+
+	scanValid = false;											// we have reached the end of the directory
+	isComplete = true;
+	return numEntries != 0;
+}
+
+// End
@@ -0,0 +1,52 @@
+/*
+ * DirectoryCache.h
+ *
+ *  Created on: 16 Oct 2026
+ *      Author: agent
+ */
+
+#ifndef SRC_STORAGE_DIRECTORYCACHE_H_
+#define SRC_STORAGE_DIRECTORYCACHE_H_
+
+#include "RepRapFirmware.h"
+
+struct FileInfo;
+class MassStorage;
+
+// Class to keep the entries of the directory that was listed last, so that clients polling the file list and fetching it a page at a time
+// don't make us read the whole directory from the SD card every time.
+// We keep as many consecutive entries as fit in the cache, starting at the entry that was asked for. If a client asks for an entry outside
+// that range then we read the directory again starting from that entry. When a client walks through a directory that is too big for the cache,
+// we carry on reading it from where we stopped instead of starting again, unless something else has used FindFirst since.
+// MassStorage invalidates the cache whenever any file or directory is created, written, deleted or renamed, or a card is mounted or unmounted.
+class DirectoryCache
+{
+public:
+	DirectoryCache(MassStorage& ms);
+
+	bool FindFirst(const char *directory, unsigned int startAt, FileInfo& fileInfo);	// Get entry number 'startAt' of a directory, returning false if there is no such entry
+	bool FindNext(FileInfo& fileInfo);													// Get the next entry, returning false if there are no more
+	void Invalidate() { isValid = scanValid = false; }
+
+private:
+	struct EntryHeader;
+
+	bool Fill(unsigned int startAt);
+	bool GetEntry(FileInfo& fileInfo);
+
+	MassStorage& massStorage;
+	String<FILENAME_LENGTH> directory;					// the directory whose entries we hold
+	unsigned int firstIndex;							// the number of the first entry we hold
+	unsigned int numEntries;							// how many entries we hold
+	unsigned int nextIndex;								// the number of the entry that FindNext will return
+	size_t nextOffset;									// where that entry is in the cache, if we hold it
+	size_t bytesUsed;
+	unsigned int scanIndex;								// the number of the entry that MassStorage::FindNext will return next, if scanValid
+	uint32_t scanSequence;								// the MassStorage find sequence number when we called FindFirst
+	bool isValid;
+	bool scanValid;										// true if we may be able to carry on reading the directory from scanIndex
+	bool isComplete;									// true if we hold all the entries from firstIndex to the end of the directory
+	uint32_t data[DirectoryCacheSize/sizeof(uint32_t)];
+};
+
+#endif /* SRC_STORAGE_DIRECTORYCACHE_H_ */
@@ -0,0 +1,40 @@
+/*
+ * FileClusterMap.h
+ *
+ *  Created on: 16 Oct 2026
+ *      Author: agent
+ */
+
+#ifndef SRC_STORAGE_FILECLUSTERMAP_H_
+#define SRC_STORAGE_FILECLUSTERMAP_H_
+
+#include "RepRapFirmware.h"
+#include "Libraries/Fatfs/ff.h"
+
+#if SAM4E || SAM4S || SAME70
+const size_t NumFileClusterMaps = 4;					// Number of cluster maps
+const size_t FileClusterMapEntries = 66;				// Size of each map in 32-bit words, enough for a file in up to 32 fragments
+#else
+const size_t NumFileClusterMaps = 2;
+const size_t FileClusterMapEntries = 34;				// enough for up to 16 fragments
+#endif
+
+// Class to hold a FatFs cluster link map table, which lets us seek within a file without following its cluster chain in the FAT.
+// The table holds the length and first cluster of each contiguous fragment of the file, so it only needs a few entries unless the card is badly fragmented.
+// We keep a small pool of these in MassStorage and lend them to files that we expect to seek in a lot, in the same way as the write buffers.
+class FileClusterMap
+{
+public:
+	FileClusterMap(FileClusterMap *n) : next(n) { }
+
+	FileClusterMap *Next() const { return next; }
+	void SetNext(FileClusterMap *n) { next = n; }
+
+	DWORD *Table() { table[0] = FileClusterMapEntries; return table; }	// FatFs needs the size of the table in the first entry before it creates the map
+
+private:
+	FileClusterMap *next;
+	DWORD table[FileClusterMapEntries];
+};
+
+#endif /* SRC_STORAGE_FILECLUSTERMAP_H_ */
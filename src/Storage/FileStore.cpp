@@ -8,7 +8,7 @@
 
 uint32_t FileStore::longestWriteTime = 0;
 
-FileStore::FileStore() : writeBuffer(nullptr)
+FileStore::FileStore() : writeBuffer(nullptr), clusterMap(nullptr)
 {
 	Init();
 }
@@ -38,6 +38,11 @@ bool FileStore::Invalidate(const FATFS *fs, bool doClose)
 				reprap.GetPlatform().GetMassStorage()->ReleaseWriteBuffer(writeBuffer);
 				writeBuffer = nullptr;
 			}
+			if (clusterMap != nullptr)
+			{
+				reprap.GetPlatform().GetMassStorage()->ReleaseClusterMap(clusterMap);
+				clusterMap = nullptr;
+			}
 			Init();
 		}
 		return true;
@@ -109,6 +114,10 @@ bool FileStore::Open(const char* directory, const char* fileName, OpenMode mode)
 		}
 		return false;
 	}
+	if (writing)
+	{
+		reprap.GetPlatform().GetMassStorage()->InvalidateDirectoryCache();	// the file may be new, or its size and date may change
+	}
 	crc.Reset();
 	inUse = true;
 	openCount = 1;
@@ -185,7 +194,17 @@ bool FileStore::ForceClose()
 		writeBuffer = nullptr;
 	}
 
+	if (clusterMap != nullptr)
+	{
+		reprap.GetPlatform().GetMassStorage()->ReleaseClusterMap(clusterMap);
+		clusterMap = nullptr;
+	}
+
 	FRESULT fr = f_close(&file);
+	if (writing)
+	{
+		reprap.GetPlatform().GetMassStorage()->InvalidateDirectoryCache();
+	}
 	inUse = false;
 	writing = false;
 	closeRequested = false;
@@ -327,6 +346,22 @@ bool FileStore::Write(const char *s, size_t len)
 	{
 		do
 		{
+			// If nothing is buffered and we have at least a buffer's worth of data left, write the whole sectors straight from the caller's data
+			const size_t bytesLeft = len - totalBytesWritten;
+			if (writeBuffer->BytesStored() == 0 && bytesLeft >= FileWriteBufLen && IsDirectTransferPossible(s + totalBytesWritten))
+			{
+				const size_t bytesToWrite = bytesLeft & ~(_MAX_SS - 1);
+				size_t bytesWritten;
+				writeStatus = Store(s + totalBytesWritten, bytesToWrite, &bytesWritten);
+				totalBytesWritten += bytesWritten;
+				if (bytesToWrite != bytesWritten)
+				{
+					// Something went wrong
+					break;
+				}
+				continue;
+			}
+
 			size_t bytesStored = writeBuffer->Store(s + totalBytesWritten, len - totalBytesWritten);
 			if (writeBuffer->BytesLeft() == 0)
 			{
@@ -389,24 +424,38 @@ float FileStore::GetAndClearLongestWriteTime()
 	return ret;
 }
 
-#if 0	// not currently used
-
-// Provide a cluster map for fast seeking. Needs _USE_FASTSEEK defined as 1 in conf_fatfs to make any difference.
-// The first element of the table must be set to the total number of 32-bit entries in the table before calling this.
-bool FileStore::SetClusterMap(uint32_t tbl[])
+// Try to borrow a cluster map from the pool and use it for fast seeking, returning true if successful.
+// Building the map costs one walk of the FAT chain, after which seeks and reads across cluster boundaries don't need to read the FAT.
+// FatFs can't extend a file in fast seek mode, so this may only be used on files opened for reading.
+// If no map is free or the file has too many fragments to fit in one, we carry on using normal seeks.
+bool FileStore::EnableFastSeek()
 {
-	if (!inUse)
+	if (!inUse || writing)
 	{
-		platform->Message(ErrorMessage, "attempt to set cluster map for a non-open file.\n");
 		return false;
 	}
+	if (clusterMap != nullptr)
+	{
+		return true;
+	}
 
-	file.cltbl = tbl;
-	FRESULT ret = f_lseek(&file, CREATE_LINKMAP);
-//	debugPrintf("ret %d need %u\n", (int)ret, tbl[0]);
-	return ret == FR_OK;
-}
+	clusterMap = reprap.GetPlatform().GetMassStorage()->AllocateClusterMap();
+	if (clusterMap == nullptr)
+	{
+		return false;
+	}
 
-#endif
+	const FilePosition pos = file.fptr;
+	file.cltbl = clusterMap->Table();
+	if (f_lseek(&file, CREATE_LINKMAP) == FR_OK && f_lseek(&file, pos) == FR_OK)
+	{
+		return true;
+	}
+
+	file.cltbl = nullptr;
+	reprap.GetPlatform().GetMassStorage()->ReleaseClusterMap(clusterMap);
+	clusterMap = nullptr;
+	return false;
+}
 
 // End
@@ -9,6 +9,7 @@
 
 class Platform;
 class FileWriteBuffer;
+class FileClusterMap;
 
 enum class OpenMode : uint8_t
 {
@@ -44,9 +45,7 @@ public:
 	bool IsOpenOn(const FATFS *fs) const;			// Return true if the file is open on the specified file system
 	uint32_t GetCRC32() const;
 
-#if 0	// not currently used
-	bool SetClusterMap(uint32_t[]);					// Provide a cluster map for fast seeking
-#endif
+	bool EnableFastSeek();							// Try to get a cluster map so that seeking doesn't need to follow the FAT chain
 	static float GetAndClearLongestWriteTime();		// Return the longest time it took to write a block to a file, in milliseconds
 
 	friend class MassStorage;
@@ -54,9 +53,11 @@ public:
 private:
 	void Init();
 	FRESULT Store(const char *s, size_t len, size_t *bytesWritten); // Write data to the non-volatile storage
+	bool IsDirectTransferPossible(const char *buf) const;
 
     FIL file;
 	FileWriteBuffer *writeBuffer;
+	FileClusterMap *clusterMap;
 	volatile unsigned int openCount;
 	volatile bool closeRequested;
 
@@ -74,4 +75,12 @@ inline uint32_t FileStore::GetCRC32() const
 	return crc.Get();
 }
 
+// Return true if data can be transferred between this buffer and the file in whole sectors.
+// FatFs transfers whole sectors at sector boundaries as multi-block reads or writes straight to or from the caller's buffer, without going through its
+// sector window (which is shared between all files because we use _FS_TINY). The HSMCI DMA needs the buffer to be 32-bit aligned.
+inline bool FileStore::IsDirectTransferPossible(const char *buf) const
+{
+	return (file.fptr & (_MAX_SS - 1)) == 0 && (reinterpret_cast<uint32_t>(buf) & 3) == 0;
+}
+
 #endif
@@ -1,6 +1,7 @@
 #include "MassStorage.h"
 #include "Platform.h"
 #include "RepRap.h"
+#include "PrintFileIndex.h"
 #include "sd_mmc.h"
 
 // Static helper functions - not declared as class members to avoid having to include sd_mmc.h everywhere
@@ -48,7 +49,7 @@ static const char* TranslateCardError(sd_mmc_err_t err)
 }
 
 // Mass Storage class
-MassStorage::MassStorage(Platform* p) : freeWriteBuffers(nullptr)
+MassStorage::MassStorage(Platform* p) : findSequence(0), freeWriteBuffers(nullptr), freeClusterMaps(nullptr), testFile(nullptr), testBuffer(nullptr), directoryCache(*this)
 {
 }
 
@@ -59,6 +60,11 @@ void MassStorage::Init()
 		freeWriteBuffers = new FileWriteBuffer(freeWriteBuffers);
 	}
 
+	for (size_t i = 0; i < NumFileClusterMaps; ++i)
+	{
+		freeClusterMaps = new FileClusterMap(freeClusterMaps);
+	}
+
 	for (size_t card = 0; card < NumSdCards; ++card)
 	{
 		SdCardInfo& inf = info[card];
@@ -66,6 +72,9 @@ void MassStorage::Init()
 		inf.mounting = inf.isMounted = false;
 		inf.cdPin = SdCardDetectPins[card];
 		inf.cardState = CardDetectState::present;
+#if SUPPORT_RAM_DISK
+		inf.isRamDisk = false;
+#endif
 	}
 
 	sd_mmc_init(SdWriteProtectPins, SdSpiCSPins);		// initialize SD MMC stack
@@ -104,6 +113,25 @@ void MassStorage::ReleaseWriteBuffer(FileWriteBuffer *buffer)
 	freeWriteBuffers = buffer;
 }
 
+FileClusterMap *MassStorage::AllocateClusterMap()
+{
+	if (freeClusterMaps == nullptr)
+	{
+		return nullptr;
+	}
+
+	FileClusterMap * const map = freeClusterMaps;
+	freeClusterMaps = map->Next();
+	map->SetNext(nullptr);
+	return map;
+}
+
+void MassStorage::ReleaseClusterMap(FileClusterMap *map)
+{
+	map->SetNext(freeClusterMaps);
+	freeClusterMaps = map;
+}
+
 FileStore* MassStorage::OpenFile(const char* directory, const char* fileName, OpenMode mode)
 {
 	for (size_t i = 0; i < MAX_FILES; i++)
@@ -194,6 +222,7 @@ bool MassStorage::FindFirst(const char *directory, FileInfo &file_info)
 		loc[len - 1] = 0;
 	}
 
+	++findSequence;
 	findDir.lfn = nullptr;
 	FRESULT res = f_opendir(&findDir, loc);
 	if (res == FR_OK)
@@ -284,6 +313,7 @@ bool MassStorage::Delete(const char* directory, const char* fileName, bool silen
 		f_close(&file);
 	}
 
+	directoryCache.Invalidate();
 	if (f_unlink(location) != FR_OK)
 	{
 		if (!silent)
@@ -292,6 +322,13 @@ bool MassStorage::Delete(const char* directory, const char* fileName, bool silen
 		}
 		return false;
 	}
+
+	// If it was a G-code file with a print file index, delete the index too
+	String<FILENAME_LENGTH> indexName;
+	if (PrintFileIndex::MakeIndexFileName(location, indexName.GetRef()))
+	{
+		(void)f_unlink(indexName.c_str());
+	}
 	return true;
 }
 
@@ -299,6 +336,7 @@ bool MassStorage::Delete(const char* directory, const char* fileName, bool silen
 bool MassStorage::MakeDirectory(const char *parentDir, const char *dirName)
 {
 	const char* const location = reprap.GetPlatform().GetMassStorage()->CombineName(parentDir, dirName);
+	directoryCache.Invalidate();
 	if (f_mkdir(location) != FR_OK)
 	{
 		reprap.GetPlatform().MessageF(ErrorMessage, "Failed to create directory %s\n", location);
@@ -309,6 +347,7 @@ bool MassStorage::MakeDirectory(const char *parentDir, const char *dirName)
 
 bool MassStorage::MakeDirectory(const char *directory)
 {
+	directoryCache.Invalidate();
 	if (f_mkdir(directory) != FR_OK)
 	{
 		reprap.GetPlatform().MessageF(ErrorMessage, "Failed to create directory %s\n", directory);
@@ -327,11 +366,26 @@ bool MassStorage::Rename(const char *oldFilename, const char *newFilename)
 		// We are assuming that the user isn't really trying to rename across volumes. This is a safe assumption when the client is DWC.
 		newFilename += 2;
 	}
+	directoryCache.Invalidate();
 	if (f_rename(oldFilename, newFilename) != FR_OK)
 	{
 		reprap.GetPlatform().MessageF(ErrorMessage, "Failed to rename file or directory %s to %s\n", oldFilename, newFilename);
 		return false;
 	}
+
+	// If it was a G-code file with a print file index, keep the index with it
+	String<FILENAME_LENGTH> oldIndexName, newIndexName;
+	if (   PrintFileIndex::MakeIndexFileName(oldFilename, oldIndexName.GetRef())
+		&& PrintFileIndex::MakeIndexFileName(newFilename, newIndexName.GetRef())
+		&& FileExists(oldIndexName.c_str())
+	   )
+	{
+		(void)f_unlink(newIndexName.c_str());
+		if (f_rename(oldIndexName.c_str(), newIndexName.c_str()) != FR_OK)
+		{
+			(void)f_unlink(oldIndexName.c_str());
+		}
+	}
 	return true;
 }
 
@@ -388,6 +442,7 @@ bool MassStorage::SetLastModifiedTime(const char* directory, const char *fileNam
 	FILINFO fno;
     fno.fdate = (WORD)(((timeInfo->tm_year - 80) * 512U) | (timeInfo->tm_mon + 1) * 32U | timeInfo->tm_mday);
     fno.ftime = (WORD)(timeInfo->tm_hour * 2048U | timeInfo->tm_min * 32U | timeInfo->tm_sec / 2U);
+    directoryCache.Invalidate();
     const bool ok = (f_utime(location, &fno) == FR_OK);
     if (!ok)
 	{
@@ -438,7 +493,11 @@ GCodeResult MassStorage::Mount(size_t card, const StringRef& reply, bool reportS
 		return GCodeResult::notFinished;						// wait for debounce to finish
 	}
 
+#if SUPPORT_RAM_DISK
+	const sd_mmc_err_t err = (disk_ram_sectors(card) != 0) ? SD_MMC_OK : sd_mmc_check(card);
+#else
 	const sd_mmc_err_t err = sd_mmc_check(card);
+#endif
 	if (err != SD_MMC_OK && millis() - inf.mountStartTime < 5000)
 	{
 		delay(2);
@@ -454,6 +513,7 @@ GCodeResult MassStorage::Mount(size_t card, const StringRef& reply, bool reportS
 	}
 
 	// Mount the file systems
+	directoryCache.Invalidate();
 	const FRESULT mounted = f_mount(card, &inf.fileSystem);
 	if (mounted != FR_OK)
 	{
@@ -462,6 +522,13 @@ GCodeResult MassStorage::Mount(size_t card, const StringRef& reply, bool reportS
 	}
 
 	inf.isMounted = true;
+#if SUPPORT_RAM_DISK
+	if (reportSuccess && disk_ram_sectors(card) != 0)
+	{
+		reply.printf("RAM disk mounted in slot %u", card);
+	}
+	else
+#endif
 	if (reportSuccess)
 	{
 		float capacity = ((float)sd_mmc_get_capacity(card) * 1024) / 1000000;		// get capacity and convert from Kib to Mbytes
@@ -500,6 +567,153 @@ GCodeResult MassStorage::Unmount(size_t card, const StringRef& reply)
 	return GCodeResult::ok;
 }
 
+// Measure how fast we can write a file of the specified size to a card and read it back, then how fast we can read it at random places
+// and list the G-code directory. This is called repeatedly until it returns something other than notFinished.
+// We write and read whole aligned buffers so that the data goes to and from the card in multi-block transfers, the same as in file uploads and downloads.
+// The random reads are short and use fast seek, the same as reading a print file after a pause or from a layer index.
+// We only do a few transfers per call so that the other modules keep running, and we only count the time spent in the file system.
+GCodeResult MassStorage::TestThroughput(size_t card, uint32_t numBytes, const StringRef& reply)
+{
+	constexpr unsigned int BuffersPerCall = 8;
+	constexpr unsigned int SeeksPerCall = 32;
+	constexpr unsigned int NumSeeks = 256;
+	constexpr size_t SeekReadLength = 512;
+
+	if (testBuffer == nullptr)
+	{
+		if (card >= NumSdCards || !info[card].isMounted)
+		{
+			reply.printf("SD card %u is not mounted", card);
+			return GCodeResult::error;
+		}
+
+		testBuffer = AllocateWriteBuffer();
+		if (testBuffer == nullptr)
+		{
+			reply.copy("No buffer available for the test");
+			return GCodeResult::error;
+		}
+
+		testFileName.GetRef().printf("%u:/speedtest.tmp", card);
+		testFile = OpenFile(nullptr, testFileName.c_str(), OpenMode::write);
+		if (testFile == nullptr)
+		{
+			reply.printf("Failed to create file %s", testFileName.c_str());
+			EndThroughputTest();
+			return GCodeResult::error;
+		}
+
+		memset(testBuffer->Data(), 0x55, FileWriteBufLen);
+		testBytes = max<uint32_t>(((numBytes + FileWriteBufLen - 1)/FileWriteBufLen) * FileWriteBufLen, FileWriteBufLen);
+		testBytesDone = testWriteMicros = testReadMicros = testSeekMicros = 0;
+		testPhase = TestPhase::writing;
+	}
+
+	const uint32_t startTime = micros();
+	bool ok = true;
+	switch (testPhase)
+	{
+	case TestPhase::writing:
+	case TestPhase::reading:
+		for (unsigned int i = 0; ok && i < BuffersPerCall && testBytesDone < testBytes; ++i)
+		{
+			ok = (testPhase == TestPhase::reading)
+					? testFile->Read(testBuffer->Data(), FileWriteBufLen) == (int)FileWriteBufLen
+						: testFile->Write(testBuffer->Data(), FileWriteBufLen);
+			testBytesDone += FileWriteBufLen;
+		}
+
+		if (ok && testBytesDone == testBytes)
+		{
+			// Finished this phase, so close the file. It doesn't count as written until it has been closed.
+			ok = testFile->Close();
+			testFile = nullptr;
+			if (ok)
+			{
+				((testPhase == TestPhase::reading) ? testReadMicros : testWriteMicros) += micros() - startTime;
+				testFile = OpenFile(nullptr, testFileName.c_str(), OpenMode::read);
+				ok = (testFile != nullptr);
+				testPhase = (testPhase == TestPhase::reading) ? TestPhase::seeking : TestPhase::reading;
+				testBytesDone = 0;							// in the seeking phase this counts the random reads
+				if (ok)
+				{
+					if (testPhase == TestPhase::seeking)
+					{
+						(void)testFile->EnableFastSeek();	// if there is no cluster map free then we measure ordinary seeks
+					}
+					return GCodeResult::notFinished;
+				}
+			}
+		}
+		break;
+
+	case TestPhase::seeking:
+		for (unsigned int i = 0; ok && i < SeeksPerCall && testBytesDone < NumSeeks; ++i)
+		{
+			const FilePosition pos = random(testBytes - SeekReadLength);
+			ok = testFile->Seek(pos) && testFile->Read(testBuffer->Data(), SeekReadLength) == (int)SeekReadLength;
+			++testBytesDone;
+		}
+		testSeekMicros += micros() - startTime;
+
+		if (ok && testBytesDone == NumSeeks)
+		{
+			// Finally list the G-code directory. We do this in one go because the search uses the shared directory object.
+			String<FILENAME_LENGTH> dir;
+			dir.GetRef().printf("%u:/gcodes", card);
+			const uint32_t listStartTime = micros();
+			unsigned int numFiles = 0;
+			FileInfo fileInfo;
+			if (FindFirst(dir.c_str(), fileInfo))
+			{
+				do
+				{
+					++numFiles;
+				} while (FindNext(fileInfo));
+			}
+			const uint32_t listMicros = micros() - listStartTime;
+
+			reply.printf("SD card %u wrote %" PRIu32 " Kbytes at %.2f Mbytes/sec, read them at %.2f Mbytes/sec, %u random %u-byte reads took %.2fms each,"
+							" listing %u files in %s took %.1fms",
+							card, testBytes/1024, (double)testBytes/testWriteMicros, (double)testBytes/testReadMicros,
+							NumSeeks, SeekReadLength, (double)testSeekMicros/(NumSeeks * 1000),
+							numFiles, dir.c_str(), (double)listMicros/1000);
+			EndThroughputTest();
+			return GCodeResult::ok;
+		}
+		break;
+	}
+
+	if (!ok)
+	{
+		reply.printf("Failed to %s file %s", (testPhase == TestPhase::writing) ? "write" : "read", testFileName.c_str());
+		EndThroughputTest();
+		return GCodeResult::error;
+	}
+
+	if (testPhase != TestPhase::seeking)
+	{
+		((testPhase == TestPhase::reading) ? testReadMicros : testWriteMicros) += micros() - startTime;
+	}
+	return GCodeResult::notFinished;
+}
+
+// Tidy up after the throughput test
+void MassStorage::EndThroughputTest()
+{
+	if (testFile != nullptr)
+	{
+		testFile->Close();
+		testFile = nullptr;
+	}
+	if (testBuffer != nullptr)
+	{
+		ReleaseWriteBuffer(testBuffer);
+		testBuffer = nullptr;
+	}
+	(void)Delete(nullptr, testFileName.c_str(), true);
+}
+
 // Check if the drive referenced in the specified path is mounted. Return true if it is.
 // Ideally we would try to mount it if it is not, however mounting a drive can take a long time, and the functions that call this are expected to execute quickly.
 bool MassStorage::CheckDriveMounted(const char* path)
@@ -557,12 +771,48 @@ bool MassStorage::IsCardDetected(size_t card) const
 	return info[card].cardState == CardDetectState::present;
 }
 
+#if SUPPORT_RAM_DISK
+
+// Use a memory image of a FAT file system in place of the SD card in the specified slot, or stop using it if the image is null.
+// The image must be a whole number of 512-byte sectors. The card must be mounted afterwards in the usual way.
+bool MassStorage::AttachRamDisk(size_t card, uint8_t *image, uint32_t numSectors)
+{
+	if (card >= NumSdCards || info[card].isMounted || info[card].mounting)
+	{
+		return false;
+	}
+	SdCardInfo& inf = info[card];
+	disk_attach_ram(card, image, numSectors);
+	if (image != nullptr)
+	{
+		if (!inf.isRamDisk)
+		{
+			inf.savedCdPin = inf.cdPin;
+			inf.savedCardState = inf.cardState;
+			inf.isRamDisk = true;
+		}
+		inf.cdPin = NoPin;
+		inf.cardState = CardDetectState::present;
+	}
+	else if (inf.isRamDisk)
+	{
+		// Go back to using the SD card
+		inf.cdPin = inf.savedCdPin;
+		inf.cardState = inf.savedCardState;
+		inf.isRamDisk = false;
+	}
+	return true;
+}
+
+#endif
+
 // Unmount a file system returning true if any pen files were invalidated
 bool MassStorage::InternalUnmount(size_t card, bool doClose)
 {
 	SdCardInfo& inf = info[card];
 	const bool invalidated = InvalidateFiles(&inf.fileSystem, doClose);
 	f_mount(card, nullptr);
+	directoryCache.Invalidate();
 	memset(&inf.fileSystem, 0, sizeof(inf.fileSystem));
 	sd_mmc_unmount(card);
 	inf.isMounted = false;
@@ -666,8 +916,18 @@ MassStorage::InfoResult MassStorage::GetCardInfo(size_t slot, uint64_t& capacity
 		return InfoResult::noCard;
 	}
 
-	capacity = (uint64_t)sd_mmc_get_capacity(slot) * 1024;
-	speed = sd_mmc_get_interface_speed(slot);
+#if SUPPORT_RAM_DISK
+	if (disk_ram_sectors(slot) != 0)
+	{
+		capacity = (uint64_t)disk_ram_sectors(slot) * 512;
+		speed = 0;
+	}
+	else
+#endif
+	{
+		capacity = (uint64_t)sd_mmc_get_capacity(slot) * 1024;
+		speed = sd_mmc_get_interface_speed(slot);
+	}
 	String<10> path;
 	path.GetRef().printf("%u:/", slot);
 	uint32_t freeClusters;
@@ -4,7 +4,10 @@
 #include "RepRapFirmware.h"
 #include "Pins.h"
 #include "FileWriteBuffer.h"
+#include "FileClusterMap.h"
+#include "DirectoryCache.h"
 #include "Libraries/Fatfs/ff.h"
+#include "Libraries/Fatfs/diskio.h"			// for SUPPORT_RAM_DISK
 #include "GCodes/GCodeResult.h"
 #include "FileStore.h"
 #include <ctime>
@@ -24,6 +27,10 @@ public:
 	FileStore* OpenFile(const char* directory, const char* fileName, OpenMode mode);
 	bool FindFirst(const char *directory, FileInfo &file_info);
 	bool FindNext(FileInfo &file_info);
+	uint32_t GetFindSequence() const { return findSequence; }		// This changes whenever FindFirst is called, so callers can tell whether FindNext will carry on from where they left off
+	bool FindFirstCached(const char *directory, unsigned int startAt, FileInfo &file_info)	// Like FindFirst but starting at entry 'startAt' and using the directory cache
+		{ return directoryCache.FindFirst(directory, startAt, file_info); }
+	bool FindNextCached(FileInfo &file_info) { return directoryCache.FindNext(file_info); }
 	const char* GetMonthName(const uint8_t month);
 	const char* CombineName(const char* directory, const char* fileName);
 	bool Delete(const char* directory, const char* fileName, bool silent = false);
@@ -38,6 +45,7 @@ public:
 	bool SetLastModifiedTime(const char* directory, const char *file, time_t time);
 	GCodeResult Mount(size_t card, const StringRef& reply, bool reportSuccess);
 	GCodeResult Unmount(size_t card, const StringRef& reply);
+	GCodeResult TestThroughput(size_t card, uint32_t numBytes, const StringRef& reply);	// Measure the file write, read, seek and listing speed of a card
 	bool IsDriveMounted(size_t drive) const { return drive < NumSdCards && info[drive].isMounted; }
 	bool CheckDriveMounted(const char* path);
 	bool IsCardDetected(size_t card) const;
@@ -56,6 +64,10 @@ public:
 
 	InfoResult GetCardInfo(size_t slot, uint64_t& capacity, uint64_t& freeSpace, uint32_t& speed);
 
+#if SUPPORT_RAM_DISK
+	bool AttachRamDisk(size_t card, uint8_t *image, uint32_t numSectors);	// Use a memory image in place of an SD card
+#endif
+
 friend class Platform;
 friend class FileStore;
 
@@ -65,6 +77,9 @@ protected:
 
 	FileWriteBuffer *AllocateWriteBuffer();
 	void ReleaseWriteBuffer(FileWriteBuffer *buffer);
+	FileClusterMap *AllocateClusterMap();
+	void ReleaseClusterMap(FileClusterMap *map);
+	void InvalidateDirectoryCache() { directoryCache.Invalidate(); }
 
 private:
 	enum class CardDetectState : uint8_t
@@ -75,6 +90,13 @@ private:
 		removing
 	};
 
+	enum class TestPhase : uint8_t
+	{
+		writing = 0,
+		reading,
+		seeking
+	};
+
 	struct SdCardInfo
 	{
 		FATFS fileSystem;
@@ -84,16 +106,37 @@ private:
 		bool mounting;
 		bool isMounted;
 		CardDetectState cardState;
+#if SUPPORT_RAM_DISK
+		bool isRamDisk;
+		Pin savedCdPin;									// the card detect pin and state to restore when the RAM disk is detached
+		CardDetectState savedCardState;
+#endif
 	};
 
 	bool InternalUnmount(size_t card, bool doClose);
+	void EndThroughputTest();
 	static time_t ConvertTimeStamp(uint16_t fdate, uint16_t ftime);
 
 	SdCardInfo info[NumSdCards];
 
 	DIR findDir;
+	uint32_t findSequence;
 	char combinedName[FILENAME_LENGTH + 1];
 	FileWriteBuffer *freeWriteBuffers;
+	FileClusterMap *freeClusterMaps;
+
+	// State of the throughput test
+	FileStore *testFile;
+	FileWriteBuffer *testBuffer;
+	String<16> testFileName;
+	uint32_t testBytes;
+	uint32_t testBytesDone;
+	uint32_t testWriteMicros;
+	uint32_t testReadMicros;
+	uint32_t testSeekMicros;
+	TestPhase testPhase;
+
+	DirectoryCache directoryCache;
 
 	FileStore files[MAX_FILES];
 };